@@ -5,11 +5,33 @@ import numpy as np
 import pandas as pd
 import seaborn as sns
 
-# Read data (../data/Cannon_best_angle_data.json)
+# The header of the binary trajectory files (integration/intergartor/TrajectoryWriter.hpp)
+TRAJECTORY_HEADER = np.dtype([('magic', 'S8'), ('version', '<u4'), ('columns', '<u4'), ('state_size', '<u4'),
+                              ('has_rhs', '<u4'), ('block_rows', '<u8'), ('rows', '<u8'), ('reserved', 'V24')])
+
+
+def read_trajectory(path):
+    """Returns the columns (time, state, rhs) of a binary trajectory file as a (columns, rows) array."""
+    header = np.fromfile(path, dtype=TRAJECTORY_HEADER, count=1)[0]
+    if header['magic'] != b'ADAAITRJ':
+        raise ValueError(f'{path} is not a trajectory file')
+
+    columns, block_rows, rows = int(header['columns']), int(header['block_rows']), int(header['rows'])
+    blocks = (rows + block_rows - 1) // block_rows
+
+    data = np.memmap(path, dtype='<f8', mode='r', offset=TRAJECTORY_HEADER.itemsize,
+                     shape=(blocks, columns, block_rows))
+    return data.transpose(1, 0, 2).reshape(columns, blocks * block_rows)[:, :rows]
+
+
+# Read data (../data/Cannon_best_angle_data.json and the trajectory it refers to)
 data = json.load(open('data/Cannon_best_angle_data.json'))
+trajectory = read_trajectory('data/' + data['trajectory'])
 
 # Create a DataFrame
-df = pd.json_normalize(data['data'])
+df = pd.DataFrame(trajectory.T, columns=['current_time',
+                                         'current_state.x', 'current_state.y', 'current_state.v_x', 'current_state.v_y',
+                                         'rhs.v_x', 'rhs.v_y', 'rhs.a_x', 'rhs.a_y'])
 print(df.info())
 
 df['v'] = np.sqrt(df['current_state.v_x'] ** 2 + df['current_state.v_y'] ** 2)
@@ -0,0 +1,330 @@
+#pragma once
+
+#include <cmath>
+
+namespace ADAAI::Diff::AAD
+{
+  /// \brief Truncated power series x(t0 + h) = sum of c_k * h^k over k = 0...Order (arbitrary order forward AD)
+  /// \details The arithmetic and the elementary functions use the O(Order^2) recurrences on the coefficients,
+  ///          c_k = x^(k)(t0) / k!
+  /// \tparam Order The highest power of h
+  template<int Order>
+  class TaylorSeries
+  {
+    static_assert( Order >= 0, "TaylorSeries: The order must be non-negative" );
+
+    double c[Order + 1] = { 0 }; // The normalized Taylor coefficients
+
+  public:
+    constexpr static int order = Order;
+
+    TaylorSeries() = default;
+
+    /// \brief creates the constant series with value v
+    constexpr explicit TaylorSeries( double v )
+    {
+      c[0] = v;
+    }
+
+    /// \brief creates the series of the independent variable t = v + h
+    constexpr static TaylorSeries Variable( double v )
+    {
+      TaylorSeries res( v );
+      if constexpr ( Order >= 1 )
+      {
+        res.c[1] = 1.0;
+      }
+      return res;
+    }
+
+    /// \brief the k-th normalized coefficient (x^(k)(t0) / k!)
+    constexpr double& operator[]( int k )
+    {
+      return c[k];
+    }
+
+    constexpr double operator[]( int k ) const
+    {
+      return c[k];
+    }
+
+    /// \brief returns x(t0)
+    [[nodiscard]] constexpr double value() const
+    {
+      return c[0];
+    }
+
+    /// \brief returns the k-th derivative x^(k)(t0)
+    [[nodiscard]] constexpr double derivative( int k ) const
+    {
+      double factorial = 1.0;
+      for ( int j = 2; j <= k; ++j )
+      {
+        factorial *= j;
+      }
+      return c[k] * factorial;
+    }
+
+    /// \brief evaluates the truncated series at t0 + h (Horner scheme)
+    [[nodiscard]] constexpr double evaluate( double h ) const
+    {
+      double res = c[Order];
+      for ( int k = Order - 1; k >= 0; --k )
+      {
+        res = res * h + c[k];
+      }
+      return res;
+    }
+
+    TaylorSeries operator-() const
+    {
+      TaylorSeries res;
+      for ( int k = 0; k <= Order; ++k )
+      {
+        res.c[k] = -c[k];
+      }
+      return res;
+    }
+
+    TaylorSeries& operator+=( const TaylorSeries& g )
+    {
+      for ( int k = 0; k <= Order; ++k )
+      {
+        c[k] += g.c[k];
+      }
+      return *this;
+    }
+
+    TaylorSeries& operator-=( const TaylorSeries& g )
+    {
+      for ( int k = 0; k <= Order; ++k )
+      {
+        c[k] -= g.c[k];
+      }
+      return *this;
+    }
+
+    TaylorSeries& operator*=( const TaylorSeries& g )
+    {
+      return *this = *this * g;
+    }
+
+    TaylorSeries& operator/=( const TaylorSeries& g )
+    {
+      return *this = *this / g;
+    }
+
+    TaylorSeries& operator+=( double v )
+    {
+      c[0] += v;
+      return *this;
+    }
+
+    TaylorSeries& operator-=( double v )
+    {
+      c[0] -= v;
+      return *this;
+    }
+
+    TaylorSeries& operator*=( double v )
+    {
+      for ( int k = 0; k <= Order; ++k )
+      {
+        c[k] *= v;
+      }
+      return *this;
+    }
+
+    TaylorSeries& operator/=( double v )
+    {
+      for ( int k = 0; k <= Order; ++k )
+      {
+        c[k] /= v;
+      }
+      return *this;
+    }
+
+    friend TaylorSeries operator+( TaylorSeries f, const TaylorSeries& g )
+    {
+      return f += g;
+    }
+
+    friend TaylorSeries operator-( TaylorSeries f, const TaylorSeries& g )
+    {
+      return f -= g;
+    }
+
+    friend TaylorSeries operator+( TaylorSeries f, double v )
+    {
+      return f += v;
+    }
+
+    friend TaylorSeries operator+( double v, TaylorSeries f )
+    {
+      return f += v;
+    }
+
+    friend TaylorSeries operator-( TaylorSeries f, double v )
+    {
+      return f -= v;
+    }
+
+    friend TaylorSeries operator-( double v, const TaylorSeries& f )
+    {
+      return -f + v;
+    }
+
+    friend TaylorSeries operator*( TaylorSeries f, double v )
+    {
+      return f *= v;
+    }
+
+    friend TaylorSeries operator*( double v, TaylorSeries f )
+    {
+      return f *= v;
+    }
+
+    friend TaylorSeries operator/( TaylorSeries f, double v )
+    {
+      return f /= v;
+    }
+
+    friend TaylorSeries operator/( double v, const TaylorSeries& f )
+    {
+      return TaylorSeries( v ) / f;
+    }
+
+    /// \brief (fg)_k = sum of f_j * g_(k - j) over j = 0...k
+    friend TaylorSeries operator*( const TaylorSeries& f, const TaylorSeries& g )
+    {
+      TaylorSeries res;
+      for ( int k = 0; k <= Order; ++k )
+      {
+        double sum = 0.0;
+        for ( int j = 0; j <= k; ++j )
+        {
+          sum += f.c[j] * g.c[k - j];
+        }
+        res.c[k] = sum;
+      }
+      return res;
+    }
+
+    /// \brief q = f / g: q_k = (f_k - sum of g_j * q_(k - j) over j = 1...k) / g_0
+    friend TaylorSeries operator/( const TaylorSeries& f, const TaylorSeries& g )
+    {
+      TaylorSeries res;
+      for ( int k = 0; k <= Order; ++k )
+      {
+        double sum = f.c[k];
+        for ( int j = 1; j <= k; ++j )
+        {
+          sum -= g.c[j] * res.c[k - j];
+        }
+        res.c[k] = sum / g.c[0];
+      }
+      return res;
+    }
+
+    /// \brief s = sqrt(f): s_k = (f_k - sum of s_j * s_(k - j) over j = 1...k - 1) / (2 * s_0)
+    friend TaylorSeries sqrt( const TaylorSeries& f )
+    {
+      TaylorSeries res;
+      res.c[0] = std::sqrt( f.c[0] );
+      for ( int k = 1; k <= Order; ++k )
+      {
+        double sum = f.c[k];
+        for ( int j = 1; j < k; ++j )
+        {
+          sum -= res.c[j] * res.c[k - j];
+        }
+        res.c[k] = sum / ( 2.0 * res.c[0] );
+      }
+      return res;
+    }
+
+    /// \brief p = f^alpha: p_k = sum of (alpha * (k - j) - j) * f_(k - j) * p_j over j = 0...k - 1 / (k * f_0)
+    friend TaylorSeries pow( const TaylorSeries& f, double alpha )
+    {
+      TaylorSeries res;
+      res.c[0] = std::pow( f.c[0], alpha );
+      for ( int k = 1; k <= Order; ++k )
+      {
+        double sum = 0.0;
+        for ( int j = 0; j < k; ++j )
+        {
+          sum += ( alpha * ( k - j ) - j ) * f.c[k - j] * res.c[j];
+        }
+        res.c[k] = sum / ( k * f.c[0] );
+      }
+      return res;
+    }
+
+    /// \brief e = exp(f): e_k = sum of j * f_j * e_(k - j) over j = 1...k / k
+    friend TaylorSeries exp( const TaylorSeries& f )
+    {
+      TaylorSeries res;
+      res.c[0] = std::exp( f.c[0] );
+      for ( int k = 1; k <= Order; ++k )
+      {
+        double sum = 0.0;
+        for ( int j = 1; j <= k; ++j )
+        {
+          sum += j * f.c[j] * res.c[k - j];
+        }
+        res.c[k] = sum / k;
+      }
+      return res;
+    }
+
+    /// \brief l = log(f): l_k = (f_k - sum of j * l_j * f_(k - j) over j = 1...k - 1 / k) / f_0
+    friend TaylorSeries log( const TaylorSeries& f )
+    {
+      TaylorSeries res;
+      res.c[0] = std::log( f.c[0] );
+      for ( int k = 1; k <= Order; ++k )
+      {
+        double sum = 0.0;
+        for ( int j = 1; j < k; ++j )
+        {
+          sum += j * res.c[j] * f.c[k - j];
+        }
+        res.c[k] = ( f.c[k] - sum / k ) / f.c[0];
+      }
+      return res;
+    }
+
+    /// \brief s = sin(f) and c = cos(f) together: s_k = sum of j * f_j * c_(k - j) / k, c_k = -sum of j * f_j * s_(k - j) / k
+    friend void sincos( const TaylorSeries& f, TaylorSeries& s, TaylorSeries& c )
+    {
+      s.c[0] = std::sin( f.c[0] );
+      c.c[0] = std::cos( f.c[0] );
+      for ( int k = 1; k <= Order; ++k )
+      {
+        double sum_s = 0.0;
+        double sum_c = 0.0;
+        for ( int j = 1; j <= k; ++j )
+        {
+          sum_s += j * f.c[j] * c.c[k - j];
+          sum_c += j * f.c[j] * s.c[k - j];
+        }
+        s.c[k] = sum_s / k;
+        c.c[k] = -sum_c / k;
+      }
+    }
+
+    friend TaylorSeries sin( const TaylorSeries& f )
+    {
+      TaylorSeries s, c;
+      sincos( f, s, c );
+      return s;
+    }
+
+    friend TaylorSeries cos( const TaylorSeries& f )
+    {
+      TaylorSeries s, c;
+      sincos( f, s, c );
+      return c;
+    }
+  };
+} // namespace ADAAI::Diff::AAD
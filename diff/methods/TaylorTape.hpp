@@ -0,0 +1,439 @@
+#pragma once
+
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "TaylorSeries.hpp"
+
+namespace ADAAI::Diff::AAD
+{
+  template<int Order>
+  class TaylorTape;
+
+  /// \brief The operations recorded on a Taylor tape
+  enum class TaylorOperation
+  {
+    Input, // set by the caller
+    Negate,
+    Add,
+    Subtract,
+    Multiply,
+    Divide,
+    AddScalar,      // f + v
+    ScalarSubtract, // v - f
+    MultiplyScalar, // f * v
+    ScalarDivide,   // v / f
+    Sqrt,
+    Pow, // f^v
+    Exp,
+    Log,
+    Sin, // the second operand is the cosine
+    Cos, // the second operand is the sine
+  };
+
+  /// \brief A value recorded on a Taylor tape: the code written for double (e.g. an RHS) runs on it unchanged
+  /// \details Every operation appends a node to the tape and computes its coefficient 0. The later coefficients are
+  ///          computed by TaylorTape::compute pass by pass, without running the code again.
+  template<int Order>
+  class TaylorNode
+  {
+    friend class TaylorTape<Order>;
+
+    TaylorTape<Order>* m_tape  = nullptr;
+    int                m_index = -1;
+
+    TaylorNode( TaylorTape<Order>* tape, int index )
+        : m_tape( tape ), m_index( index )
+    {
+    }
+
+    static TaylorNode record( TaylorOperation operation, const TaylorNode& f, const TaylorNode* g = nullptr, double v = 0.0 )
+    {
+      return f.m_tape->record( operation, f.m_index, g ? g->m_index : -1, v );
+    }
+
+    static std::pair<TaylorNode, TaylorNode> sincos( const TaylorNode& f )
+    {
+      return f.m_tape->sincos( f );
+    }
+
+  public:
+    TaylorNode() = default;
+
+    /// \brief the series of the node (the coefficients computed so far)
+    [[nodiscard]] const TaylorSeries<Order>& series() const
+    {
+      return m_tape->series( *this );
+    }
+
+    /// \brief returns x(t0)
+    [[nodiscard]] double value() const
+    {
+      return series()[0];
+    }
+
+    TaylorNode operator-() const
+    {
+      return record( TaylorOperation::Negate, *this );
+    }
+
+    TaylorNode& operator+=( const TaylorNode& g )
+    {
+      return *this = *this + g;
+    }
+
+    TaylorNode& operator-=( const TaylorNode& g )
+    {
+      return *this = *this - g;
+    }
+
+    TaylorNode& operator*=( const TaylorNode& g )
+    {
+      return *this = *this * g;
+    }
+
+    TaylorNode& operator/=( const TaylorNode& g )
+    {
+      return *this = *this / g;
+    }
+
+    TaylorNode& operator+=( double v )
+    {
+      return *this = *this + v;
+    }
+
+    TaylorNode& operator-=( double v )
+    {
+      return *this = *this - v;
+    }
+
+    TaylorNode& operator*=( double v )
+    {
+      return *this = *this * v;
+    }
+
+    TaylorNode& operator/=( double v )
+    {
+      return *this = *this / v;
+    }
+
+    friend TaylorNode operator+( const TaylorNode& f, const TaylorNode& g )
+    {
+      return record( TaylorOperation::Add, f, &g );
+    }
+
+    friend TaylorNode operator-( const TaylorNode& f, const TaylorNode& g )
+    {
+      return record( TaylorOperation::Subtract, f, &g );
+    }
+
+    friend TaylorNode operator*( const TaylorNode& f, const TaylorNode& g )
+    {
+      return record( TaylorOperation::Multiply, f, &g );
+    }
+
+    friend TaylorNode operator/( const TaylorNode& f, const TaylorNode& g )
+    {
+      return record( TaylorOperation::Divide, f, &g );
+    }
+
+    friend TaylorNode operator+( const TaylorNode& f, double v )
+    {
+      return record( TaylorOperation::AddScalar, f, nullptr, v );
+    }
+
+    friend TaylorNode operator+( double v, const TaylorNode& f )
+    {
+      return f + v;
+    }
+
+    friend TaylorNode operator-( const TaylorNode& f, double v )
+    {
+      return f + ( -v );
+    }
+
+    friend TaylorNode operator-( double v, const TaylorNode& f )
+    {
+      return record( TaylorOperation::ScalarSubtract, f, nullptr, v );
+    }
+
+    friend TaylorNode operator*( const TaylorNode& f, double v )
+    {
+      return record( TaylorOperation::MultiplyScalar, f, nullptr, v );
+    }
+
+    friend TaylorNode operator*( double v, const TaylorNode& f )
+    {
+      return f * v;
+    }
+
+    friend TaylorNode operator/( const TaylorNode& f, double v )
+    {
+      return f * ( 1.0 / v );
+    }
+
+    friend TaylorNode operator/( double v, const TaylorNode& f )
+    {
+      return record( TaylorOperation::ScalarDivide, f, nullptr, v );
+    }
+
+    friend TaylorNode sqrt( const TaylorNode& f )
+    {
+      return record( TaylorOperation::Sqrt, f );
+    }
+
+    friend TaylorNode pow( const TaylorNode& f, double alpha )
+    {
+      return record( TaylorOperation::Pow, f, nullptr, alpha );
+    }
+
+    friend TaylorNode exp( const TaylorNode& f )
+    {
+      return record( TaylorOperation::Exp, f );
+    }
+
+    friend TaylorNode log( const TaylorNode& f )
+    {
+      return record( TaylorOperation::Log, f );
+    }
+
+    friend TaylorNode sin( const TaylorNode& f )
+    {
+      return sincos( f ).first;
+    }
+
+    friend TaylorNode cos( const TaylorNode& f )
+    {
+      return sincos( f ).second;
+    }
+  };
+
+  /// \brief The recorded operations of the code run on TaylorNode, computed coefficient by coefficient
+  /// \details The coefficient k of a node needs only the coefficients 0...k of its operands (and 0...k - 1 of
+  ///          itself), as in the recurrences of TaylorSeries. So the coefficient k of every node is O(k) and all
+  ///          of them up to Order are O(Order^2) per node, where the evaluation on TaylorSeries is O(Order^2) per
+  ///          node for every coefficient. The inputs are set by the caller before the pass of their coefficient,
+  ///          e.g. y_(k + 1) = f_k / (k + 1) of the ODE y' = f(t, y).
+  ///          The branches of the code are taken by the coefficients 0 of the recording.
+  /// \tparam Order The highest power of h
+  template<int Order>
+  class TaylorTape
+  {
+    friend class TaylorNode<Order>;
+
+    using Series = TaylorSeries<Order>;
+
+    using Operation = TaylorOperation;
+
+    struct Node
+    {
+      Operation operation;
+      int       f;
+      int       g;
+      double    v;
+      Series    series;
+    };
+
+    std::vector<Node> m_nodes;
+
+    TaylorNode<Order> append( Operation operation, int f, int g, double v )
+    {
+      m_nodes.push_back( { operation, f, g, v, Series() } );
+      return { this, static_cast<int>( m_nodes.size() ) - 1 };
+    }
+
+    TaylorNode<Order> record( Operation operation, int f, int g, double v )
+    {
+      auto node = append( operation, f, g, v );
+      compute( node.m_index, 0 );
+      return node;
+    }
+
+    /// \brief sin(f) and cos(f) refer to each other, so they are recorded together
+    std::pair<TaylorNode<Order>, TaylorNode<Order>> sincos( const TaylorNode<Order>& f )
+    {
+      int  index = static_cast<int>( m_nodes.size() );
+      auto s     = append( Operation::Sin, f.m_index, index + 1, 0.0 );
+      auto c     = append( Operation::Cos, f.m_index, index, 0.0 );
+      compute( s.m_index, 0 );
+      compute( c.m_index, 0 );
+      return { s, c };
+    }
+
+    /// \brief The coefficient k of the node (the recurrences of TaylorSeries)
+    void compute( int index, int k )
+    {
+      Node&         node = m_nodes[index];
+      double&       res  = node.series[k];
+      const Series& f    = node.f >= 0 ? m_nodes[node.f].series : node.series;
+      const Series& g    = node.g >= 0 ? m_nodes[node.g].series : node.series;
+      const Series& r    = node.series;
+
+      double sum = 0.0;
+      switch ( node.operation )
+      {
+      case Operation::Input:
+        break;
+      case Operation::Negate:
+        res = -f[k];
+        break;
+      case Operation::Add:
+        res = f[k] + g[k];
+        break;
+      case Operation::Subtract:
+        res = f[k] - g[k];
+        break;
+      case Operation::Multiply:
+        for ( int j = 0; j <= k; ++j )
+        {
+          sum += f[j] * g[k - j];
+        }
+        res = sum;
+        break;
+      case Operation::Divide:
+        sum = f[k];
+        for ( int j = 1; j <= k; ++j )
+        {
+          sum -= g[j] * r[k - j];
+        }
+        res = sum / g[0];
+        break;
+      case Operation::AddScalar:
+        res = k == 0 ? f[0] + node.v : f[k];
+        break;
+      case Operation::ScalarSubtract:
+        res = k == 0 ? node.v - f[0] : -f[k];
+        break;
+      case Operation::MultiplyScalar:
+        res = node.v * f[k];
+        break;
+      case Operation::ScalarDivide:
+        sum = k == 0 ? node.v : 0.0;
+        for ( int j = 1; j <= k; ++j )
+        {
+          sum -= f[j] * r[k - j];
+        }
+        res = sum / f[0];
+        break;
+      case Operation::Sqrt:
+        if ( k == 0 )
+        {
+          res = std::sqrt( f[0] );
+          break;
+        }
+        sum = f[k];
+        for ( int j = 1; j < k; ++j )
+        {
+          sum -= r[j] * r[k - j];
+        }
+        res = sum / ( 2.0 * r[0] );
+        break;
+      case Operation::Pow:
+        if ( k == 0 )
+        {
+          res = std::pow( f[0], node.v );
+          break;
+        }
+        for ( int j = 0; j < k; ++j )
+        {
+          sum += ( node.v * ( k - j ) - j ) * f[k - j] * r[j];
+        }
+        res = sum / ( k * f[0] );
+        break;
+      case Operation::Exp:
+        if ( k == 0 )
+        {
+          res = std::exp( f[0] );
+          break;
+        }
+        for ( int j = 1; j <= k; ++j )
+        {
+          sum += j * f[j] * r[k - j];
+        }
+        res = sum / k;
+        break;
+      case Operation::Log:
+        if ( k == 0 )
+        {
+          res = std::log( f[0] );
+          break;
+        }
+        for ( int j = 1; j < k; ++j )
+        {
+          sum += j * r[j] * f[k - j];
+        }
+        res = ( f[k] - sum / k ) / f[0];
+        break;
+      case Operation::Sin:
+        if ( k == 0 )
+        {
+          res = std::sin( f[0] );
+          break;
+        }
+        for ( int j = 1; j <= k; ++j )
+        {
+          sum += j * f[j] * g[k - j];
+        }
+        res = sum / k;
+        break;
+      case Operation::Cos:
+        if ( k == 0 )
+        {
+          res = std::cos( f[0] );
+          break;
+        }
+        for ( int j = 1; j <= k; ++j )
+        {
+          sum += j * f[j] * g[k - j];
+        }
+        res = -sum / k;
+        break;
+      }
+    }
+
+  public:
+    TaylorTape() = default;
+
+    // The nodes refer to the tape
+    TaylorTape( const TaylorTape& )            = delete;
+    TaylorTape& operator=( const TaylorTape& ) = delete;
+
+    /// \brief forgets the recording (the memory is kept for the next one)
+    void clear()
+    {
+      m_nodes.clear();
+    }
+
+    /// \brief records an input with x(t0) = v, its higher coefficients are set by the caller
+    TaylorNode<Order> input( double v )
+    {
+      auto node = append( Operation::Input, -1, -1, 0.0 );
+      m_nodes.back().series[0] = v;
+      return node;
+    }
+
+    /// \brief records the independent variable t = v + h
+    TaylorNode<Order> variable( double v )
+    {
+      auto node = append( Operation::Input, -1, -1, 0.0 );
+      m_nodes.back().series = Series::Variable( v );
+      return node;
+    }
+
+    /// \brief the series of the node (the coefficients of an input are written through it)
+    Series& series( const TaylorNode<Order>& node )
+    {
+      return m_nodes[node.m_index].series;
+    }
+
+    /// \brief computes the coefficient k of all of the recorded nodes (the coefficients below k must be computed)
+    void compute( int k )
+    {
+      for ( int index = 0; index < static_cast<int>( m_nodes.size() ); ++index )
+      {
+        compute( index, k );
+      }
+    }
+  };
+} // namespace ADAAI::Diff::AAD
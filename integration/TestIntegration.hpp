@@ -0,0 +1,660 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "intergartor/Interator.hpp"
+#include "intergartor/Parareal.hpp"
+#include "intergartor/Sensitivity.hpp"
+#include "intergartor/steppers/AdamsStepper.hpp"
+#include "intergartor/steppers/AutoSwitchStepper.hpp"
+#include "intergartor/steppers/BulirschStoerStepper.hpp"
+#include "intergartor/steppers/EverhartStepper.hpp"
+#include "intergartor/steppers/ExplicitRKStepper.hpp"
+#include "intergartor/steppers/ExponentialStepper.hpp"
+#include "intergartor/steppers/RadauIIAStepper.hpp"
+#include "intergartor/steppers/RosenbrockStepper.hpp"
+#include "intergartor/steppers/SymplecticStepper.hpp"
+#include "intergartor/steppers/TaylorStepper.hpp"
+#include "orbital_problem/Satellite.hpp"
+#include "pde_bsm/AucRHS.hpp"
+
+using namespace ADAAI::Integration;
+
+/// \brief Propagates one satellite with its own RHS, stepper and integrator
+/// \param altitude The initial distance from the center of the Earth (km)
+/// \param state_end The final state
+void PropagateSatellite( double altitude, double state_end[Satellite::SatelliteRHS::N] )
+{
+  double state[Satellite::SatelliteRHS::N] = { 0.0, 0.0, altitude, std::sqrt( Environment::Mu / altitude ), 0.0, 0.0 };
+
+  auto rhs      = Satellite::SatelliteRHS();
+  auto observer = Satellite::SatelliteObserver();
+  auto stepper  = Integrator::Stepper::Everhart_TimeStepper( &rhs );
+
+  auto integrator = Integrator::ODE_Integrator<Satellite::SatelliteRHS, Integrator::Stepper::Everhart_TimeStepper<Satellite::SatelliteRHS>, Satellite::SatelliteObserver>( &stepper, &observer );
+
+  integrator( state, state_end, 0.0, 2e4, 3.0 );
+}
+
+/// \brief Tracks the maximal relative energy error along the trajectory
+struct SatelliteEnergyObserver : Integrator::Observer<Satellite::SatelliteRHS>
+{
+  double         m_initial_energy;
+  mutable double m_max_error = 0.0;
+
+  explicit SatelliteEnergyObserver( double initial_energy )
+      : m_initial_energy( initial_energy )
+  {
+  }
+
+  bool operator()( [[maybe_unused]] double current_time, const double current_state[Satellite::SatelliteRHS::N] ) const override
+  {
+    m_max_error = std::max( m_max_error, std::abs( Satellite::SatelliteEnergy( current_state ) / m_initial_energy - 1.0 ) );
+    return true;
+  }
+};
+
+/// \brief Propagates a satellite with the given stepper and prints the maximal relative energy error
+template<typename TS>
+void TestEnergyConservation( const char* name, double dt )
+{
+  const double altitude = 7500.0;
+  const double t_end    = 3.1e6; // about 36 days
+
+  double state[Satellite::SatelliteRHS::N] = { 0.0, 0.0, altitude, std::sqrt( Environment::Mu / altitude ), 0.0, 0.0 };
+  double state_end[Satellite::SatelliteRHS::N];
+
+  auto rhs      = Satellite::SatelliteRHS();
+  auto observer = SatelliteEnergyObserver( Satellite::SatelliteEnergy( state ) );
+  auto stepper  = TS( &rhs );
+
+  auto integrator = Integrator::ODE_Integrator<Satellite::SatelliteRHS, TS, SatelliteEnergyObserver>( &stepper, &observer );
+  integrator( state, state_end, 0.0, t_end, dt );
+
+  std::cout << std::left << std::setw( 20 ) << name
+            << "| dt=" << std::setw( 6 ) << dt
+            << "| max energy error=" << observer.m_max_error << "\n";
+}
+
+/// \brief The satellite RHS counting its calls (thread safe for the parallel steppers)
+struct CountingSatelliteRHS : Satellite::SatelliteRHS
+{
+  mutable std::atomic<long> m_calls = 0;
+
+  void operator()( double current_time, const double* current_state, double* rhs ) const override
+  {
+    ++m_calls;
+    Satellite::SatelliteRHS::operator()( current_time, current_state, rhs );
+  }
+
+  /// \brief The evaluation on the Taylor tape (one per step) is counted as a call too
+  template<typename T>
+  void evaluate( const T& current_time, const T* current_state, T* rhs ) const
+  {
+    ++m_calls;
+    Satellite::SatelliteRHS::evaluate( current_time, current_state, rhs );
+  }
+};
+
+struct CountingSatelliteObserver : Integrator::Observer<CountingSatelliteRHS>
+{
+  bool operator()( [[maybe_unused]] double current_time, [[maybe_unused]] const double current_state[CountingSatelliteRHS::N] ) const override
+  {
+    return true;
+  }
+};
+
+/// \brief Propagates a satellite for 1.2e5 s and prints the RHS calls, the time and the final position
+/// \return The statistics of the integration
+template<typename TS, typename... Args>
+Integrator::IntegrationStats BenchmarkSatellite( const char* name, Args... args )
+{
+  const double altitude = 7500.0;
+
+  double state[Satellite::SatelliteRHS::N] = { 0.0, 0.0, altitude, std::sqrt( Environment::Mu / altitude ), 0.0, 0.0 };
+  double state_end[Satellite::SatelliteRHS::N];
+
+  auto rhs      = CountingSatelliteRHS();
+  auto observer = CountingSatelliteObserver();
+  auto stepper  = TS( &rhs, args... );
+
+  auto progress = Integrator::CountingProgressSink();
+
+  auto integrator = Integrator::ODE_Integrator<CountingSatelliteRHS, TS, CountingSatelliteObserver>( &stepper, &observer );
+  integrator.setProgressSink( &progress );
+
+  auto start = std::chrono::steady_clock::now();
+  integrator( state, state_end, 0.0, 1.2e5, 10.0 );
+  std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+
+  std::cout << std::left << std::setw( 28 ) << name
+            << "| calls=" << std::setw( 8 ) << rhs.m_calls
+            << "| steps=" << std::setw( 7 ) << progress.steps()
+            << "| rejections=" << std::setw( 5 ) << progress.rejections()
+            << "| iterations=" << std::setw( 6 ) << integrator.statistics().iterations
+            << "| time=" << std::setw( 12 ) << time.count()
+            << "| x=" << std::setprecision( 13 ) << state_end[0] << std::setprecision( 6 ) << "\n";
+
+  return integrator.statistics();
+}
+
+/// \brief Prints the order of the local error of one step of the tableau (expected order + 1 or more)
+/// \details The step starts at the periapsis of an eccentric orbit: the problem is nonlinear, so the coefficients are
+///          checked against all of the order conditions (the harmonic oscillator only checks the linear ones).
+///          The reference is the same tableau with 64 substeps. The tableaus optimized for a small principal error
+///          (Tsitouras, Verner) show a higher order at the steps the local error stays above the roundoff.
+/// \param h The longer of the two steps (s)
+template<const auto& Tableau>
+void TestButcherTableau( const char* name, double h = 50.0 )
+{
+  const double r_p = 7000.0;
+  const double e   = 0.5;
+
+  auto rhs     = Satellite::SatelliteRHS();
+  auto stepper = Integrator::Stepper::ExplicitRK_TimeStepper<Satellite::SatelliteRHS, Tableau>( &rhs, 1e10, 1e10 ); // Every step is accepted
+
+  auto step = [&stepper]( const double* state, double* next_state, double dt, int substeps )
+  {
+    double current[Satellite::SatelliteRHS::N];
+    std::memcpy( current, state, sizeof( current ) );
+    stepper.reset();
+    for ( int i = 0; i < substeps; ++i )
+    {
+      stepper( current, next_state, i * dt / substeps, dt / substeps );
+      std::memcpy( current, next_state, sizeof( current ) );
+    }
+  };
+
+  double errors[2];
+  for ( int k = 0; k < 2; ++k )
+  {
+    double dt                                = h / ( 1 << k );
+    double state[Satellite::SatelliteRHS::N] = { r_p, 0.0, 0.0, 0.0, std::sqrt( Environment::Mu * ( 1.0 + e ) / r_p ), 0.0 };
+    double next_state[Satellite::SatelliteRHS::N];
+    double reference[Satellite::SatelliteRHS::N];
+
+    step( state, next_state, dt, 1 );
+    step( state, reference, dt, 64 );
+
+    errors[k] = 0.0;
+    for ( int i = 0; i < 3; ++i )
+    {
+      errors[k] = std::max( errors[k], std::abs( next_state[i] - reference[i] ) );
+    }
+  }
+
+  std::cout << std::left << std::setw( 20 ) << name
+            << "| stages=" << std::setw( 3 ) << Tableau.stages
+            << "| order=" << std::setw( 3 ) << Tableau.order
+            << "| observed local error order=" << std::log2( errors[0] / errors[1] ) << "\n";
+}
+
+/// \brief Propagates a satellite for 4e6 s with Parareal, checks that it converges to the serial Everhart and prints the cost
+/// \details The coarse propagator is Yoshida 6 with the fixed step of 60 s (Störmer-Verlet doesn't converge: its phase
+///          error over a slice is too big)
+/// \details The coarse propagator is Everhart with a loose tolerance. Besides the measured time the speedup is
+///          projected for more cores from the times of the fine slices (the coarse sweeps stay serial).
+void TestParareal()
+{
+  using Fine   = Integrator::Stepper::Everhart_TimeStepper<Satellite::SatelliteRHS>;
+  using Coarse = Integrator::Stepper::Symplectic_TimeStepper<Satellite::SatelliteRHS, 6>;
+
+  const double altitude = 7500.0;
+  const double t_end    = 4e6;
+  const int    slices   = 64;
+  const int    workers  = static_cast<int>( std::max( 1u, std::thread::hardware_concurrency() ) );
+
+  double state[Satellite::SatelliteRHS::N] = { 0.0, 0.0, altitude, std::sqrt( Environment::Mu / altitude ), 0.0, 0.0 };
+  double serial_end[Satellite::SatelliteRHS::N];
+  double parareal_end[Satellite::SatelliteRHS::N];
+
+  auto rhs      = Satellite::SatelliteRHS();
+  auto observer = Satellite::SatelliteObserver();
+  auto fine     = Fine( &rhs, 1e-12 );
+  auto coarse   = Coarse( &rhs );
+
+  auto integrator = Integrator::ODE_Integrator<Satellite::SatelliteRHS, Fine, Satellite::SatelliteObserver>( &fine, &observer );
+
+  auto start = std::chrono::steady_clock::now();
+  integrator( state, serial_end, 0.0, t_end, 3.0 );
+  std::chrono::duration<double> serial_time = std::chrono::steady_clock::now() - start;
+
+  auto parareal = Integrator::Parareal_Integrator<Satellite::SatelliteRHS, Coarse, Fine>(
+      &coarse, [&rhs]()
+      { return std::make_unique<Fine>( &rhs, 1e-12 ); },
+      60.0, 3.0, slices, workers, 1e-10 );
+  parareal( state, parareal_end, 0.0, t_end );
+
+  const auto& stats = parareal.statistics();
+
+  double error = 0.0;
+  for ( int i = 0; i < 3; ++i )
+  {
+    error = std::max( error, std::abs( serial_end[i] - parareal_end[i] ) );
+  }
+
+  std::cout << "Parareal (" << slices << " slices, " << workers << " workers): iterations=" << stats.iterations
+            << " | time=" << stats.total_time << " (serial " << serial_time.count() << ", coarse " << stats.coarse_time << ")"
+            << " | speedup=" << serial_time.count() / stats.total_time
+            << " | position difference=" << error << " km\n";
+
+  std::cout << "Projected speedup (from the measured slice times):";
+  for ( int cores = 1; cores <= slices; cores *= 2 )
+  {
+    std::cout << " " << cores << "=" << serial_time.count() / stats.projectedTime( cores );
+  }
+  std::cout << "\n";
+
+  if ( !( stats.change <= 1e-10 ) || stats.iterations >= slices || !( error <= 1e-5 ) )
+  {
+    throw std::runtime_error( "TestParareal: Parareal has not converged to the serial integration" );
+  }
+}
+
+/// \brief Checks that the integration resumed from a checkpoint in the middle is bitwise identical to the uninterrupted one
+template<typename TS, typename... Args>
+void TestCheckpointResume( const char* name, Args... args )
+{
+  using Integrator_t = Integrator::ODE_Integrator<Satellite::SatelliteRHS, TS, Satellite::SatelliteObserver>;
+
+  const double      altitude = 7500.0;
+  const double      t_end    = 1.2e5;
+  const std::string path     = "./../data/TestIntegration_checkpoint.bin";
+
+  double state[Satellite::SatelliteRHS::N] = { 0.0, 0.0, altitude, std::sqrt( Environment::Mu / altitude ), 0.0, 0.0 };
+  double uninterrupted_end[Satellite::SatelliteRHS::N];
+  double resumed_end[Satellite::SatelliteRHS::N];
+
+  auto rhs      = Satellite::SatelliteRHS();
+  auto observer = Satellite::SatelliteObserver();
+
+  // The uninterrupted run gives the number of steps, the second one writes a single checkpoint half way
+  auto stepper = TS( &rhs, args... );
+  auto counted = Integrator_t( &stepper, &observer );
+  counted( state, uninterrupted_end, 0.0, t_end, 10.0 );
+  {
+    auto writer     = Integrator::CheckpointWriter( path );
+    auto integrator = Integrator_t( &stepper, &observer );
+    integrator.setCheckpoints( &writer, std::max( 1L, counted.statistics().accepted_steps / 2 + 1 ) );
+    integrator( state, uninterrupted_end, 0.0, t_end, 10.0 );
+    writer.finish();
+  }
+
+  // A fresh stepper continues from the file as a restarted program would
+  auto checkpoint      = Integrator::ReadCheckpoint( path );
+  auto resumed_stepper = TS( &rhs, args... );
+  Integrator_t( &resumed_stepper, &observer ).resume( checkpoint, resumed_end, t_end );
+  std::remove( path.c_str() );
+
+  bool identical = std::memcmp( uninterrupted_end, resumed_end, sizeof( resumed_end ) ) == 0;
+
+  std::cout << std::left << std::setw( 28 ) << name
+            << "| resumed at t=" << std::setw( 10 ) << checkpoint.time << " (step " << checkpoint.steps << "): "
+            << ( identical ? "bitwise identical" : "DIFFERENT" ) << "\n";
+}
+
+/// \brief Tracks the maximal error of the harmonic oscillator (x(0) = 1, v(0) = 0) against the analytic solution
+struct HarmonicOscErrorObserver : Integrator::Observer<Integrator::HarmonicOsc_RHS>
+{
+  double         m_omega;
+  mutable double m_max_error = 0.0;
+  mutable int    m_calls     = 0;
+
+  explicit HarmonicOscErrorObserver( double omega )
+      : m_omega( omega )
+  {
+  }
+
+  bool operator()( double current_time, const double current_state[Integrator::HarmonicOsc_RHS::N] ) const override
+  {
+    m_max_error = std::max( { m_max_error, std::abs( current_state[0] - std::cos( m_omega * current_time ) ),
+                              std::abs( current_state[1] + m_omega * std::sin( m_omega * current_time ) ) } );
+    ++m_calls;
+    return true;
+  }
+};
+
+/// \brief Checks the dense output of the stepper against the analytic oscillator at the output times between the steps
+/// \param max_error The largest error accepted
+template<typename TS, typename... Args>
+void TestDenseOutput( const char* name, double max_error, Args... args )
+{
+  const double omega = 1.0;
+  const double t_end = 20.0 * M_PI;
+
+  // The output times are incommensurate with the steps
+  std::vector<double> output_times;
+  for ( double t = 0.0137; t < t_end; t += 0.0731 )
+  {
+    output_times.push_back( t );
+  }
+
+  double state[Integrator::HarmonicOsc_RHS::N] = { 1.0, 0.0 };
+  double state_end[Integrator::HarmonicOsc_RHS::N];
+
+  auto rhs      = Integrator::HarmonicOsc_RHS( omega );
+  auto observer = HarmonicOscErrorObserver( omega );
+  auto stepper  = TS( &rhs, args... );
+
+  auto integrator = Integrator::ODE_Integrator<Integrator::HarmonicOsc_RHS, TS, HarmonicOscErrorObserver>( &stepper, &observer );
+  integrator.setOutputTimes( output_times );
+  integrator( state, state_end, 0.0, t_end, 0.01 );
+
+  std::cout << std::left << std::setw( 28 ) << name
+            << "| outputs=" << std::setw( 5 ) << observer.m_calls
+            << "| steps=" << std::setw( 5 ) << integrator.statistics().accepted_steps
+            << "| max dense output error=" << observer.m_max_error << "\n";
+
+  if ( observer.m_max_error > max_error || observer.m_calls < static_cast<int>( output_times.size() ) )
+  {
+    throw std::runtime_error( std::string( "TestDenseOutput: The dense output of " ) + name + " is off" );
+  }
+}
+
+/// \brief Sweeps the tolerance of the stepper on the oscillator: the work must grow and the error follow the tolerance
+/// \details The steppers take ( &rhs, tolerance, tolerance ). The error is the maximal one of the steps on 10 periods
+template<typename TS>
+void TestToleranceSweep( const char* name )
+{
+  const double omega = 1.0;
+  const double t_end = 20.0 * M_PI;
+
+  long previous_calls = 0;
+  for ( double tolerance = 1e-4; tolerance > 1e-13; tolerance /= 10.0 )
+  {
+    double state[Integrator::HarmonicOsc_RHS::N] = { 1.0, 0.0 };
+    double state_end[Integrator::HarmonicOsc_RHS::N];
+
+    auto rhs      = Integrator::HarmonicOsc_RHS( omega );
+    auto observer = HarmonicOscErrorObserver( omega );
+    auto stepper  = TS( &rhs, tolerance, tolerance );
+
+    auto integrator = Integrator::ODE_Integrator<Integrator::HarmonicOsc_RHS, TS, HarmonicOscErrorObserver>( &stepper, &observer );
+    integrator( state, state_end, 0.0, t_end, 0.01 );
+
+    long calls = stepper.rhsCalls();
+
+    std::cout << std::left << std::setw( 28 ) << name
+              << "| tolerance=" << std::setw( 7 ) << tolerance
+              << "| calls=" << std::setw( 6 ) << calls
+              << "| max error=" << observer.m_max_error << "\n";
+
+    if ( calls <= previous_calls || observer.m_max_error > 100.0 * tolerance )
+    {
+      throw std::runtime_error( std::string( "TestToleranceSweep: " ) + name + " doesn't follow the tolerance" );
+    }
+    previous_calls = calls;
+  }
+}
+
+/// \brief y' = -lambda(t) (y - cos t) - sin t with a stiff pulse of lambda around t = 5 and z' = -z, counting its calls
+/// \details The solution is y = cos t, z = exp(-t) for y(0) = z(0) = 1 whatever lambda is
+struct StiffPulseRHS : Integrator::RHS
+{
+  constexpr static int N = 2;
+
+  mutable std::atomic<long> m_calls = 0;
+
+  void operator()( double current_time, const double* current_state, double* rhs ) const override
+  {
+    ++m_calls;
+    double lambda = 1.0 + 1e4 * std::exp( -( current_time - 5.0 ) * ( current_time - 5.0 ) );
+    rhs[0]        = -lambda * ( current_state[0] - std::cos( current_time ) ) - std::sin( current_time );
+    rhs[1]        = -current_state[1];
+  }
+};
+
+struct StiffPulseObserver : Integrator::Observer<StiffPulseRHS>
+{
+  bool operator()( [[maybe_unused]] double current_time, [[maybe_unused]] const double current_state[StiffPulseRHS::N] ) const override
+  {
+    return true;
+  }
+};
+
+/// \brief Checks that the switching stepper goes implicit for the stiff pulse and back, and counts all of its RHS calls
+void TestAutoSwitch()
+{
+  using AutoSwitch = Integrator::Stepper::AutoSwitch_TimeStepper<StiffPulseRHS>;
+
+  const double t_end = 10.0;
+
+  double state[StiffPulseRHS::N] = { 1.0, 1.0 };
+  double state_end[StiffPulseRHS::N];
+
+  auto rhs      = StiffPulseRHS();
+  auto observer = StiffPulseObserver();
+  auto stepper  = AutoSwitch( &rhs );
+
+  auto integrator = Integrator::ODE_Integrator<StiffPulseRHS, AutoSwitch, StiffPulseObserver>( &stepper, &observer );
+  integrator( state, state_end, 0.0, t_end, 1e-3 );
+
+  double error = std::max( std::abs( state_end[0] - std::cos( t_end ) ), std::abs( state_end[1] - std::exp( -t_end ) ) );
+  long   calls = integrator.statistics().rhs_calls;
+
+  std::cout << "AutoSwitch on the stiff pulse: switches=" << stepper.switches()
+            << " | calls=" << calls << " (counted by the RHS " << rhs.m_calls << ")"
+            << " | error=" << error << "\n";
+
+  if ( stepper.switches() < 2 || error > 1e-4 || ( Integrator::StatisticsEnabled && calls != rhs.m_calls ) )
+  {
+    throw std::runtime_error( "TestAutoSwitch: The stepper didn't switch back and forth or lost RHS calls" );
+  }
+}
+
+/// \brief The premium of the auction PDE (sigma and r jump at the breakpoints of the RHS) by the given stepper
+template<typename TS>
+double AucPremium()
+{
+  const double tau_max = 1.0;
+
+  double state[PDE_BSM::AucRHS::N];
+  double state_end[PDE_BSM::AucRHS::N];
+  PDE_BSM::AucFunc::initStartCondition( state );
+
+  auto rhs      = PDE_BSM::AucRHS();
+  auto observer = PDE_BSM::AucObserver();
+  auto stepper  = TS( &rhs );
+
+  auto integrator = Integrator::ODE_Integrator<PDE_BSM::AucRHS, TS>( &stepper, &observer );
+  integrator( state, state_end, 0.0, tau_max, tau_max / 1000 );
+
+  return PDE_BSM::AucFunc::get_c( state_end, 0.9 * PDE_BSM::AucRHS::K );
+}
+
+/// \brief Checks that the steppers landing on the breakpoints take sigma and r of the step there
+/// \details The exponential stepper evaluates the RHS inside the intervals of constant sigma and r only, so it is
+///          the reference. The stages and the Jacobians of the others at the ends of the steps must not mix intervals
+void TestBreakpointLimits()
+{
+  using PDE_BSM::AucRHS;
+
+  double exponential = AucPremium<Integrator::Stepper::Exponential_TimeStepper<AucRHS>>();
+  double rosenbrock  = AucPremium<Integrator::Stepper::Rosenbrock_TimeStepper<AucRHS>>();
+  double radau       = AucPremium<Integrator::Stepper::RadauIIA_TimeStepper<AucRHS>>();
+  double auto_switch = AucPremium<Integrator::Stepper::AutoSwitch_TimeStepper<AucRHS>>();
+
+  double deviation = std::max( { std::abs( rosenbrock - exponential ), std::abs( radau - exponential ), std::abs( auto_switch - exponential ) } );
+
+  std::cout << std::setprecision( 13 )
+            << "Auction premiums: exponential=" << exponential << " | Rosenbrock=" << rosenbrock
+            << " | Radau IIA=" << radau << " | AutoSwitch=" << auto_switch << std::setprecision( 6 )
+            << " | max deviation=" << deviation << "\n";
+
+  if ( !( deviation <= 1e-6 ) )
+  {
+    throw std::runtime_error( "TestBreakpointLimits: The premiums of the steppers disagree" );
+  }
+}
+
+/// \brief The auction PDE without its Jacobian (the sensitivities take the directional differences)
+struct AucRHSWithoutJacobian : Integrator::RHS
+{
+  constexpr static int N = PDE_BSM::AucRHS::N;
+
+  PDE_BSM::AucRHS m_rhs;
+
+  void operator()( double current_time, const double* current_state, double* rhs ) const override
+  {
+    m_rhs( current_time, current_state, rhs );
+  }
+};
+
+/// \brief Checks the variational equations J s of the auction PDE with its Jacobian against the directional differences
+/// \details The state is the payoff and s is its derivative by the strike, at a time inside every interval of sigma and r
+void TestSensitivityJacobian()
+{
+  using PDE_BSM::AucRHS;
+  constexpr int N = AucRHS::N;
+
+  auto rhs            = AucRHS();
+  auto rhs_difference = AucRHSWithoutJacobian();
+  auto exact          = Integrator::SensitivityRHS<AucRHS, 1>( &rhs );
+  auto difference     = Integrator::SensitivityRHS<AucRHSWithoutJacobian, 1>( &rhs_difference );
+  static_assert( Integrator::JacobianRHS<AucRHS> && !Integrator::JacobianRHS<AucRHSWithoutJacobian> );
+
+  double state[2 * N];
+  PDE_BSM::AucFunc::initStartCondition( state );
+  for ( int i = 0; i < N; ++i )
+  {
+    state[N + i] = i * AucRHS::S_max / N > AucRHS::K ? -1.0 : 0.0;
+  }
+
+  double deviation = 0.0;
+  for ( double t : { 0.1, 0.3, 0.6, 0.9 } )
+  {
+    double f_exact[2 * N];
+    double f_difference[2 * N];
+    exact( t, state, f_exact );
+    difference( t, state, f_difference );
+
+    double scale = 0.0;
+    double error = 0.0;
+    for ( int i = N; i < 2 * N; ++i )
+    {
+      scale = std::max( scale, std::abs( f_exact[i] ) );
+      error = std::max( error, std::abs( f_exact[i] - f_difference[i] ) );
+    }
+    deviation = std::max( deviation, error / scale );
+  }
+
+  std::cout << "Auction sensitivities: Jacobian vs directional differences | max relative deviation=" << deviation << "\n";
+
+  if ( !( deviation <= 1e-6 ) )
+  {
+    throw std::runtime_error( "TestSensitivityJacobian: The sensitivities of the Jacobian and of the differences disagree" );
+  }
+}
+
+/// \brief Checks that the satellites propagated in parallel are bitwise identical to the serial ones
+void TestIntegration()
+{
+  const int number_of_satellites = 8;
+
+  std::vector<double> altitudes( number_of_satellites );
+  for ( int i = 0; i < number_of_satellites; ++i )
+  {
+    altitudes[i] = 7000.0 + 250.0 * i;
+  }
+
+  std::vector<double> serial( number_of_satellites * Satellite::SatelliteRHS::N );
+  std::vector<double> parallel( number_of_satellites * Satellite::SatelliteRHS::N );
+
+  for ( int i = 0; i < number_of_satellites; ++i )
+  {
+    PropagateSatellite( altitudes[i], serial.data() + i * Satellite::SatelliteRHS::N );
+  }
+
+  std::vector<std::thread> threads;
+  for ( int i = 0; i < number_of_satellites; ++i )
+  {
+    threads.emplace_back( PropagateSatellite, altitudes[i], parallel.data() + i * Satellite::SatelliteRHS::N );
+  }
+  for ( auto& thread : threads )
+  {
+    thread.join();
+  }
+
+  bool identical = std::memcmp( serial.data(), parallel.data(), serial.size() * sizeof( double ) ) == 0;
+
+  std::cout << "\n=========================\n";
+  std::cout << "Serial and parallel propagation of " << number_of_satellites << " satellites: "
+            << ( identical ? "bitwise identical" : "DIFFERENT" ) << "\n=========================\n";
+
+  // The dense output between the steps against the analytic solution
+  TestDenseOutput<Integrator::Stepper::Everhart_TimeStepper<Integrator::HarmonicOsc_RHS>>( "Everhart 1e-12", 1e-9, 1e-12 );
+  TestDenseOutput<Integrator::Stepper::ExplicitRK_TimeStepper<Integrator::HarmonicOsc_RHS, Integrator::Stepper::DormandPrince54>>( "Dormand-Prince 5(4) 1e-10", 1e-6, 1e-10, 1e-10 );
+  TestDenseOutput<Integrator::Stepper::Adams_TimeStepper<Integrator::HarmonicOsc_RHS>>( "Adams 1e-12", 1e-9, 1e-12, 1e-12 );
+  TestDenseOutput<Integrator::Stepper::Taylor_TimeStepper<Integrator::HarmonicOsc_RHS, 20>>( "Taylor-20 1e-14", 1e-11, 1e-14 );
+  std::cout << "=========================\n";
+
+  TestAutoSwitch();
+  std::cout << "=========================\n";
+
+  TestBreakpointLimits();
+  std::cout << "=========================\n";
+
+  TestSensitivityJacobian();
+  std::cout << "=========================\n";
+
+  // The order and step control of the extrapolation
+  TestToleranceSweep<Integrator::Stepper::BulirschStoer_TimeStepper<Integrator::HarmonicOsc_RHS>>( "Bulirsch-Stoer" );
+  std::cout << "=========================\n";
+
+  // Adaptive Everhart against the fixed step symplectic compositions with large steps
+  TestEnergyConservation<Integrator::Stepper::Everhart_TimeStepper<Satellite::SatelliteRHS>>( "Everhart", 3.0 );
+  TestEnergyConservation<Integrator::Stepper::Symplectic_TimeStepper<Satellite::SatelliteRHS, 2>>( "Stormer-Verlet", 10.0 );
+  TestEnergyConservation<Integrator::Stepper::Symplectic_TimeStepper<Satellite::SatelliteRHS, 4>>( "Yoshida 4", 60.0 );
+  TestEnergyConservation<Integrator::Stepper::Symplectic_TimeStepper<Satellite::SatelliteRHS, 6>>( "Yoshida 6", 120.0 );
+  TestEnergyConservation<Integrator::Stepper::Symplectic_TimeStepper<Satellite::SatelliteRHS, 8>>( "Yoshida 8", 120.0 );
+  std::cout << "=========================\n";
+
+  // Extrapolation and the multistep Adams method against Everhart on the same arc
+  BenchmarkSatellite<Integrator::Stepper::Everhart_TimeStepper<CountingSatelliteRHS>>( "Everhart 1e-10", 1e-10 );
+  auto everhart = BenchmarkSatellite<Integrator::Stepper::Everhart_TimeStepper<CountingSatelliteRHS>>( "Everhart 1e-12", 1e-12 );
+  BenchmarkSatellite<Integrator::Stepper::Adams_TimeStepper<CountingSatelliteRHS>>( "Adams 1e-10", 1e-10, 1e-10 );
+  BenchmarkSatellite<Integrator::Stepper::Adams_TimeStepper<CountingSatelliteRHS>>( "Adams 1e-12", 1e-12, 1e-12 );
+  BenchmarkSatellite<Integrator::Stepper::BulirschStoer_TimeStepper<CountingSatelliteRHS>>( "Bulirsch-Stoer 1e-12", 1e-12, 1e-12 );
+  BenchmarkSatellite<Integrator::Stepper::BulirschStoer_TimeStepper<CountingSatelliteRHS>>( "Bulirsch-Stoer 1e-14", 1e-14, 1e-14 );
+  BenchmarkSatellite<Integrator::Stepper::BulirschStoer_TimeStepper<CountingSatelliteRHS>>( "Bulirsch-Stoer 1e-14 (par)", 1e-14, 1e-14, true );
+  BenchmarkSatellite<Integrator::Stepper::Taylor_TimeStepper<CountingSatelliteRHS, 20>>( "Taylor-20 1e-14", 1e-14 );
+  BenchmarkSatellite<Integrator::Stepper::Taylor_TimeStepper<CountingSatelliteRHS, 30>>( "Taylor-30 1e-14", 1e-14 );
+  std::cout << "Everhart 1e-12 statistics: " << everhart.toJSON() << "\n";
+  std::cout << "=========================\n";
+
+  // The explicit Runge-Kutta methods of the Butcher tableaus against each other
+  TestButcherTableau<Integrator::Stepper::RK4>( "RK4" );
+  TestButcherTableau<Integrator::Stepper::Fehlberg45>( "Fehlberg 4(5)" );
+  TestButcherTableau<Integrator::Stepper::DormandPrince54>( "Dormand-Prince 5(4)" );
+  TestButcherTableau<Integrator::Stepper::Tsitouras54>( "Tsitouras 5(4)" );
+  TestButcherTableau<Integrator::Stepper::Verner65>( "Verner 6(5)", 100.0 );
+  TestButcherTableau<Integrator::Stepper::PrinceDormand87>( "Prince-Dormand 8(7)", 200.0 );
+  BenchmarkSatellite<Integrator::Stepper::RFK45_TimeStepper<CountingSatelliteRHS>>( "RFK45" );
+  BenchmarkSatellite<Integrator::Stepper::ExplicitRK_TimeStepper<CountingSatelliteRHS, Integrator::Stepper::Fehlberg45>>( "Fehlberg 4(5) 1e-12", 1e-12, 1e-12 );
+  BenchmarkSatellite<Integrator::Stepper::ExplicitRK_TimeStepper<CountingSatelliteRHS, Integrator::Stepper::DormandPrince54>>( "Dormand-Prince 5(4) 1e-12", 1e-12, 1e-12 );
+  BenchmarkSatellite<Integrator::Stepper::ExplicitRK_TimeStepper<CountingSatelliteRHS, Integrator::Stepper::Tsitouras54>>( "Tsitouras 5(4) 1e-12", 1e-12, 1e-12 );
+  BenchmarkSatellite<Integrator::Stepper::ExplicitRK_TimeStepper<CountingSatelliteRHS, Integrator::Stepper::Verner65>>( "Verner 6(5) 1e-12", 1e-12, 1e-12 );
+  BenchmarkSatellite<Integrator::Stepper::ExplicitRK_TimeStepper<CountingSatelliteRHS, Integrator::Stepper::PrinceDormand87>>( "Prince-Dormand 8(7) 1e-12", 1e-12, 1e-12 );
+  std::cout << "=========================\n";
+
+  TestParareal();
+  std::cout << "=========================\n";
+
+  // Restart from a checkpoint against the uninterrupted integration
+  TestCheckpointResume<Integrator::Stepper::Everhart_TimeStepper<Satellite::SatelliteRHS>>( "Everhart 1e-12", 1e-12 );
+  TestCheckpointResume<Integrator::Stepper::Adams_TimeStepper<Satellite::SatelliteRHS>>( "Adams 1e-12", 1e-12, 1e-12 );
+  TestCheckpointResume<Integrator::Stepper::ExplicitRK_TimeStepper<Satellite::SatelliteRHS, Integrator::Stepper::DormandPrince54>>( "Dormand-Prince 5(4) 1e-12", 1e-12, 1e-12 );
+  std::cout << "=========================\n";
+}
@@ -0,0 +1,281 @@
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../cannon_problem/CannonBall.hpp"
+#include "../intergartor/Interator.hpp"
+#include "../intergartor/steppers/AdamsStepper.hpp"
+#include "../intergartor/steppers/AutoSwitchStepper.hpp"
+#include "../intergartor/steppers/BulirschStoerStepper.hpp"
+#include "../intergartor/steppers/EverhartStepper.hpp"
+#include "../intergartor/steppers/ExplicitRKStepper.hpp"
+#include "../intergartor/steppers/ExponentialStepper.hpp"
+#include "../intergartor/steppers/RadauIIAStepper.hpp"
+#include "../intergartor/steppers/RosenbrockStepper.hpp"
+#include "../intergartor/steppers/SymplecticStepper.hpp"
+#include "../intergartor/steppers/TaylorStepper.hpp"
+#include "../orbital_problem/Satellite.hpp"
+
+/// Work-precision curves of the steppers: the error of the final state against the RHS calls and the wall time.
+/// Every stepper runs over a sweep of its tolerance (or of its step for the fixed step ones) on the problems with
+/// a known final state. The results are written to ./../data/work_precision.csv.
+
+namespace ADAAI::Integration::Benchmark
+{
+  using Integrator::Stepper::DormandPrince54;
+  using Integrator::Stepper::Fehlberg45;
+  using Integrator::Stepper::PrinceDormand87;
+  using Integrator::Stepper::RK4;
+  using Integrator::Stepper::Tsitouras54;
+  using Integrator::Stepper::Verner65;
+
+  /// \brief The observer of the problems (the integration runs to the end)
+  template<typename RHS_I>
+  struct PassObserver : Integrator::Observer<RHS_I>
+  {
+    bool operator()( [[maybe_unused]] double current_time, [[maybe_unused]] const double current_state[] ) const override
+    {
+      return true;
+    }
+  };
+
+  /// \brief An initial value problem with the reference final state
+  template<typename RHS_I>
+  struct Problem
+  {
+    std::string         name;
+    const RHS_I*        rhs;
+    std::vector<double> state;
+    double              t_end;
+    std::vector<double> reference;
+    int                 error_size;           // The error is the max norm of the first 'error_size' components (e.g. the position)
+    bool                conservative = false; // y'' = F(y) with F independent of dy/dt (the symplectic steppers apply)
+    bool                affine       = false; // f(t, y) = A y + g(t) (the exponential stepper applies)
+  };
+
+  /// \brief One point of a work-precision curve
+  struct Measurement
+  {
+    std::string problem;
+    std::string stepper;
+    double      setting; // The tolerance or the step
+    double      error;
+    long        rhs_calls;
+    long        steps;
+    long        rejections;
+    double      time; // The wall time of one integration (seconds)
+  };
+
+  /// \brief Integrates the problem with the stepper and returns the final state
+  /// \param dt The first step (the step of the fixed step steppers)
+  /// \param stats The statistics of the integration
+  template<typename RHS_I, typename TS>
+  std::vector<double> Solve( const Problem<RHS_I>& problem, const TS& stepper, double dt, Integrator::IntegrationStats& stats )
+  {
+    PassObserver<RHS_I> observer;
+    auto                integrator = Integrator::ODE_Integrator<RHS_I, TS, PassObserver<RHS_I>>( &stepper, &observer );
+
+    std::vector<double> state_end( problem.state.size() );
+    integrator( problem.state.data(), state_end.data(), 0.0, problem.t_end, dt );
+    stats = integrator.statistics();
+
+    return state_end;
+  }
+
+  /// \brief Measures the stepper on the problem
+  /// \details The integration is repeated for at least 'min_time' seconds and the average wall time is taken
+  template<typename RHS_I, typename TS>
+  Measurement Measure( const Problem<RHS_I>& problem, const std::string& name, const TS& stepper, double setting, double dt, double min_time = 0.05 )
+  {
+    Integrator::IntegrationStats stats;
+    std::vector<double>          state_end;
+
+    int  runs  = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::duration<double> time {};
+    do
+    {
+      state_end = Solve( problem, stepper, dt, stats );
+      time      = std::chrono::steady_clock::now() - start;
+      runs++;
+    } while ( time.count() < min_time );
+
+    double error = 0.0;
+    for ( int i = 0; i < problem.error_size; ++i )
+    {
+      error = std::max( error, std::abs( state_end[i] - problem.reference[i] ) );
+    }
+
+    return { problem.name, name, setting, error, stats.rhs_calls, stats.accepted_steps, stats.rejected_steps, time.count() / runs };
+  }
+
+  /// \brief The sweeps of all of the steppers over the problem
+  /// \details The symplectic steppers run only on the conservative problems, the exponential one only on the affine
+  ///          problems and the Taylor one only on the RHS with the templated evaluation
+  /// \param fixed_dt The largest step of the fixed step steppers (it is halved 'fixed_steps' times)
+  /// \param first_dt The first step of the adaptive steppers
+  template<typename RHS_I>
+  void Sweep( const Problem<RHS_I>& problem, double fixed_dt, int fixed_steps, double first_dt, std::vector<Measurement>& results )
+  {
+    using namespace Integrator::Stepper;
+
+    const RHS_I* rhs = problem.rhs;
+
+    for ( int k = 0; k < fixed_steps; ++k )
+    {
+      double dt = fixed_dt / ( 1 << k );
+      results.push_back( Measure( problem, "Euler", DiscreteTimeStepper<RHS_I>( rhs ), dt, dt ) );
+      results.push_back( Measure( problem, "RK4", ExplicitRK_TimeStepper<RHS_I, RK4>( rhs ), dt, dt ) );
+      if ( problem.conservative )
+      {
+        results.push_back( Measure( problem, "Symplectic2", Symplectic_TimeStepper<RHS_I, 2>( rhs ), dt, dt ) );
+        results.push_back( Measure( problem, "Symplectic4", Symplectic_TimeStepper<RHS_I, 4>( rhs ), dt, dt ) );
+        results.push_back( Measure( problem, "Symplectic6", Symplectic_TimeStepper<RHS_I, 6>( rhs ), dt, dt ) );
+        results.push_back( Measure( problem, "Symplectic8", Symplectic_TimeStepper<RHS_I, 8>( rhs ), dt, dt ) );
+      }
+    }
+
+    for ( int exponent = 3; exponent <= 13; ++exponent )
+    {
+      double tolerance = std::pow( 10.0, -exponent );
+
+      // The tolerance of RFK45 bounds the squared norm of the error
+      results.push_back( Measure( problem, "RFK45", RFK45_TimeStepper<RHS_I>( rhs, tolerance * tolerance ), tolerance, first_dt ) );
+      results.push_back( Measure( problem, "Fehlberg45", ExplicitRK_TimeStepper<RHS_I, Fehlberg45>( rhs, tolerance, tolerance ), tolerance, first_dt ) );
+      results.push_back( Measure( problem, "DormandPrince54", ExplicitRK_TimeStepper<RHS_I, DormandPrince54>( rhs, tolerance, tolerance ), tolerance, first_dt ) );
+      results.push_back( Measure( problem, "Tsitouras54", ExplicitRK_TimeStepper<RHS_I, Tsitouras54>( rhs, tolerance, tolerance ), tolerance, first_dt ) );
+      results.push_back( Measure( problem, "Verner65", ExplicitRK_TimeStepper<RHS_I, Verner65>( rhs, tolerance, tolerance ), tolerance, first_dt ) );
+      results.push_back( Measure( problem, "PrinceDormand87", ExplicitRK_TimeStepper<RHS_I, PrinceDormand87>( rhs, tolerance, tolerance ), tolerance, first_dt ) );
+      results.push_back( Measure( problem, "Everhart", Everhart_TimeStepper<RHS_I>( rhs, tolerance ), tolerance, first_dt ) );
+      results.push_back( Measure( problem, "Adams", Adams_TimeStepper<RHS_I>( rhs, tolerance, tolerance ), tolerance, first_dt ) );
+      results.push_back( Measure( problem, "BulirschStoer", BulirschStoer_TimeStepper<RHS_I>( rhs, tolerance, tolerance ), tolerance, first_dt ) );
+      results.push_back( Measure( problem, "Rosenbrock", Rosenbrock_TimeStepper<RHS_I>( rhs, tolerance, tolerance ), tolerance, first_dt ) );
+      results.push_back( Measure( problem, "RadauIIA", RadauIIA_TimeStepper<RHS_I>( rhs, tolerance, tolerance ), tolerance, first_dt ) );
+      results.push_back( Measure( problem, "AutoSwitch",
+                                  AutoSwitch_TimeStepper<RHS_I>( rhs, std::make_tuple( tolerance * tolerance ), std::make_tuple( tolerance, tolerance ) ),
+                                  tolerance, first_dt ) );
+      if ( problem.affine )
+      {
+        results.push_back( Measure( problem, "Exponential", Exponential_TimeStepper<RHS_I>( rhs, tolerance ), tolerance, first_dt ) );
+      }
+      if constexpr ( TaylorRHS<RHS_I, 20> ) // The Taylor series need the templated RHS
+      {
+        results.push_back( Measure( problem, "Taylor", Taylor_TimeStepper<RHS_I>( rhs, tolerance ), tolerance, first_dt ) );
+      }
+    }
+  }
+
+  /// \brief The state of the Kepler orbit at time t (the orbit starts at the periapsis on the x axis, in the xy plane)
+  /// \param r_p The periapsis distance (km)
+  /// \param e The eccentricity (< 1)
+  inline std::vector<double> KeplerState( double r_p, double e, double t )
+  {
+    const double mu = Environment::Mu;
+    const double a  = r_p / ( 1.0 - e );
+    const double n  = std::sqrt( mu / ( a * a * a ) );
+
+    // Kepler's equation E - e sin(E) = M by Newton's method
+    double M = std::fmod( n * t, 2.0 * M_PI );
+    double E = e < 0.8 ? M : M_PI;
+    for ( int iteration = 0; iteration < 50; ++iteration )
+    {
+      double dE = ( E - e * std::sin( E ) - M ) / ( 1.0 - e * std::cos( E ) );
+      E -= dE;
+      if ( std::abs( dE ) < 1e-15 )
+      {
+        break;
+      }
+    }
+
+    const double b      = a * std::sqrt( 1.0 - e * e );
+    const double E_rate = n / ( 1.0 - e * std::cos( E ) );
+
+    return { a * ( std::cos( E ) - e ), b * std::sin( E ), 0.0, -a * std::sin( E ) * E_rate, b * std::cos( E ) * E_rate, 0.0 };
+  }
+
+  void WriteCSV( const std::string& path, const std::vector<Measurement>& results )
+  {
+    std::ofstream file( path, std::ios::out | std::ios::trunc );
+    if ( !file )
+    {
+      throw std::runtime_error( "WriteCSV: Failed to open " + path );
+    }
+
+    file << "problem,stepper,setting,error,rhs_calls,steps,rejections,time\n";
+    file << std::setprecision( 10 );
+    for ( const auto& result : results )
+    {
+      file << result.problem << ',' << result.stepper << ',' << result.setting << ',' << result.error << ','
+           << result.rhs_calls << ',' << result.steps << ',' << result.rejections << ',' << result.time << '\n';
+    }
+  }
+} // namespace ADAAI::Integration::Benchmark
+
+int main()
+{
+  using namespace ADAAI::Integration;
+  using namespace ADAAI::Integration::Benchmark;
+
+  std::vector<Measurement> results;
+
+  // The harmonic oscillator over 10 periods
+  {
+    const double omega = 1.0;
+    const double t_end = 20.0 * M_PI;
+
+    auto rhs     = Integrator::HarmonicOsc_RHS( omega );
+    auto problem = Problem<Integrator::HarmonicOsc_RHS> { "HarmonicOsc", &rhs, { 1.0, 0.0 }, t_end, { std::cos( omega * t_end ), -omega * std::sin( omega * t_end ) }, 2, true, true };
+
+    Sweep( problem, 0.1, 10, 0.01, results );
+  }
+
+  // The Kepler orbit (J2 = 0) with e = 0.5 over 3 periods
+  {
+    const double r_p    = 7000.0;
+    const double e      = 0.5;
+    const double a      = r_p / ( 1.0 - e );
+    const double period = 2.0 * M_PI * std::sqrt( a * a * a / Environment::Mu );
+
+    auto rhs     = Satellite::SatelliteRHS( 0.0 );
+    auto problem = Problem<Satellite::SatelliteRHS> { "Kepler", &rhs, KeplerState( r_p, e, 0.0 ), 3.0 * period, KeplerState( r_p, e, 3.0 * period ), 3, true };
+
+    Sweep( problem, 20.0, 10, 1.0, results );
+  }
+
+  // The cannonball with the air drag (no analytic solution: the reference is Prince-Dormand 8(7) at 1e-15, a tolerance
+  // outside of the sweep, it agrees with Everhart, Adams and Verner 6(5) to about 4e-10 m). The drag coefficient is
+  // piecewise linear in the Mach number, so the RHS is not smooth: the steps across its kinks are of a low order
+  // and the errors below about 1e-7 m are not meaningful
+  {
+    const double v     = 1640.0;
+    const double angle = 45.0 * M_PI / 180.0;
+
+    auto rhs     = CannonBall::BallRHS();
+    auto problem = Problem<CannonBall::BallRHS> { "Ball", &rhs, { 0.0, 0.0, v * std::cos( angle ), v * std::sin( angle ) }, 40.0, {}, 2 };
+
+    auto                         reference_stepper = Integrator::Stepper::ExplicitRK_TimeStepper<CannonBall::BallRHS, PrinceDormand87>( &rhs, 1e-15, 1e-15 );
+    Integrator::IntegrationStats stats;
+    problem.reference = Solve( problem, reference_stepper, 1e-3, stats );
+
+    Sweep( problem, 0.1, 10, 1e-3, results );
+  }
+
+  for ( const auto& result : results )
+  {
+    std::cout << std::left << std::setw( 12 ) << result.problem
+              << "| " << std::setw( 16 ) << result.stepper
+              << "| setting=" << std::setw( 10 ) << result.setting
+              << "| error=" << std::setw( 12 ) << result.error
+              << "| calls=" << std::setw( 9 ) << result.rhs_calls
+              << "| time=" << result.time << "\n";
+  }
+
+  WriteCSV( "./../data/work_precision.csv", results );
+
+  return 0;
+}
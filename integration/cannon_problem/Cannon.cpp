@@ -1,7 +1,8 @@
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <iostream>
-#include <thread>
-#include <vector>
+#include <string>
 
 #include "../intergartor/Interator.hpp"
 #include "CannonBall.hpp"
@@ -22,6 +23,7 @@ namespace ADAAI::Integration::Cannon
     auto stepper  = Integrator::Stepper::RFK45_TimeStepper( &rhs );
 
     auto integrator = Integrator::ODE_Integrator<CannonBall::BallRHS>( &stepper, &observer );
+    integrator.addEvent( CannonBall::GroundImpactEvent() );
 
     double t = 0.0;
     try
@@ -36,7 +38,8 @@ namespace ADAAI::Integration::Cannon
     return { end_state[0], t };
   }
 
-  void shootWithAngle( std::ostream& os, double angle = 45 )
+  /// \brief Shoots and writes the trajectory (time, x, y, v_x, v_y and the RHS) to a binary trajectory file
+  void shootWithAngle( const std::string& path, double angle = 45 )
   {
     double rad = angle * M_PI / 180.0f;
 
@@ -46,10 +49,12 @@ namespace ADAAI::Integration::Cannon
     double end_state[4];
 
     auto rhs      = CannonBall::BallRHS();
-    auto observer = CannonBall::BallDumperObserver( os );
+    auto writer   = Integrator::TrajectoryWriter<CannonBall::BallRHS>( path, true );
+    auto observer = CannonBall::BallDumperObserver( writer, &rhs );
     auto stepper  = Integrator::Stepper::RFK45_TimeStepper( &rhs );
 
-    auto integrator = Integrator::ODE_Integrator<CannonBall::BallRHS>( &stepper, &observer );
+    auto integrator = Integrator::ODE_Integrator<CannonBall::BallRHS, Integrator::Stepper::RFK45_TimeStepper<CannonBall::BallRHS>, CannonBall::BallDumperObserver>( &stepper, &observer );
+    integrator.addEvent( CannonBall::GroundImpactEvent() );
 
     double t = 0.0;
     try
@@ -61,109 +66,135 @@ namespace ADAAI::Integration::Cannon
       std::cerr << e.what() << std::endl;
     }
 
-    os << "    {\n"
-       << "      \"current_time\":" << t << ",\n"
-       << "      \"current_state\": {\n"
-       << "        \"x\": " << end_state[0] << ",\n"
-       << "        \"y\": " << end_state[1] << ",\n"
-       << "        \"v_x\": " << end_state[2] << ",\n"
-       << "        \"v_y\": " << end_state[3] << "\n"
-       << "      },\n"
-       << "      \"rhs\": {\n"
-       << "        \"v_x\": 0,\n"
-       << "        \"v_y\": 0,\n"
-       << "        \"a_x\": 0,\n"
-       << "        \"a_y\": 0\n"
-       << "      }\n"
-       << "    }\n";
+    double end_rhs[4];
+    rhs( t, end_state, end_rhs );
+    writer.append( t, end_state, end_rhs );
   }
 
-  void checkRange( std::vector<std::tuple<double, double, double>>* results, double min_angle, double max_angle, double delta_angle )
+  /// \brief The range of a shot and its derivatives
+  struct ShotResult
   {
-    for ( double angle = min_angle; angle < max_angle; angle += delta_angle )
-    {
-      auto [distance, t] = shootWithAngle( angle );
-
-      results->emplace_back( angle, distance, t );
-    }
-  }
-
-  double findBestAngle()
+    double distance   = 0.0;
+    double time       = 0.0;
+    double d_angle    = 0.0; // d(distance) / d(angle) (m per degree)
+    double d_velocity = 0.0; // d(distance) / d(v0) (m per m/s)
+  };
+
+  /// \brief Shoots with the variational equations integrated alongside the state
+  ShotResult shootWithSensitivities( double angle = 45, double v = 1640.0 )
   {
-    const int thread_cnt = ( int ) std::thread::hardware_concurrency() - 1;
+    constexpr int n = CannonBall::BallRHS::N;
 
-    const double delta_angle = 1;
-    const double min_angle   = 40.0;
-    const double max_angle   = 60.0;
-    const int    cnt_angle   = ( int ) ( ( max_angle - min_angle ) / delta_angle );
-    const double td_angle    = ( cnt_angle / thread_cnt ) * delta_angle;
+    double rad     = angle * M_PI / 180.0;
+    double cos_rad = std::cos( rad );
+    double sin_rad = std::sin( rad );
 
-    // For initialization purposes (in multy-threading it could be very useful)
-    Environment::DrugCoefficient( 1.3 );
+    double state[CannonBall::BallSensitivityRHS::N] = {
+        0.0, 0.0, v * cos_rad, v * sin_rad,                                 // x, y, v_x, v_y
+        0.0, 0.0, -v * sin_rad * M_PI / 180.0, v * cos_rad * M_PI / 180.0, // d/d(angle)
+        0.0, 0.0, cos_rad, sin_rad };                                      // d/d(v0)
+    double end_state[CannonBall::BallSensitivityRHS::N];
 
-    std::vector<std::vector<std::tuple<double, double, double>>> results( thread_cnt );
-    std::vector<std::thread>                                     threads;
+    auto ball     = CannonBall::BallRHS();
+    auto rhs      = CannonBall::BallSensitivityRHS( &ball );
+    auto observer = CannonBall::BallSensitivityObserver();
+    auto stepper  = Integrator::Stepper::RFK45_TimeStepper( &rhs );
 
-    for ( int i = 0; i < thread_cnt; i++ )
-    {
-      double l_angle = min_angle + td_angle * ( double ) i;
-      double r_angle = i != thread_cnt - 1 ? l_angle + td_angle : max_angle;
+    auto integrator = Integrator::ODE_Integrator<CannonBall::BallSensitivityRHS, Integrator::Stepper::RFK45_TimeStepper<CannonBall::BallSensitivityRHS>,
+                                                 CannonBall::BallSensitivityObserver>( &stepper, &observer );
+    integrator.addEvent( CannonBall::GroundImpactEvent<CannonBall::BallSensitivityRHS>() );
 
-      // checkRange( &results[i], l_angle, r_angle, delta_angle );
-      threads.emplace_back( checkRange, &results[i], l_angle, r_angle, delta_angle );
+    double t = 0.0;
+    try
+    {
+      t = integrator( state, end_state );
     }
-
-    for ( auto& th : threads )
+    catch ( std::exception& e )
     {
-      th.join();
+      std::cerr << e.what() << std::endl;
+      return {};
     }
 
-    double best_angle    = min_angle;
-    double best_distance = 0.0f;
+    // The impact time depends on the parameters too: y(t) = 0 gives dt/dp = -(dy/dp) / v_y
+    double slope = end_state[2] / end_state[3];
+
+    return { end_state[0], t, end_state[n] - slope * end_state[n + 1], end_state[2 * n] - slope * end_state[2 * n + 1] };
+  }
+
+  /// \brief Finds the angle of the maximal range by the secant method on d(distance)/d(angle) = 0
+  /// \details The derivative is given by the sensitivities, so each iteration is a single integration
+  double findBestAngle()
+  {
+    const double min_angle       = 40.0;
+    const double max_angle       = 60.0;
+    const double angle_step      = 1.0;  // The first step and the step if the range is not concave
+    const double angle_tolerance = 1e-6; // The search stops on this change of the angle (degrees)
+    const int    max_iterations  = 20;
 
     std::ofstream file;
     file.open( "./../data/Cannon_angle_results.data", std::ios::out | std::ios::trunc );
 
-    for ( const auto& result_block : results )
+    auto report = [&file]( double angle, const ShotResult& shot )
+    {
+      if ( shot.time != 0.0 )
+      {
+        file << "Angle: " << angle << " Distance: " << shot.distance << " dDistance/dAngle: " << shot.d_angle
+             << " dDistance/dVelocity: " << shot.d_velocity << " Time: " << shot.time << '\n';
+        std::cout << "Angle: " << angle << " Distance: " << shot.distance << " dDistance/dAngle: " << shot.d_angle
+                  << " dDistance/dVelocity: " << shot.d_velocity << " Time: " << shot.time << std::endl;
+      }
+      else
+      {
+        file << "Angle: " << angle << " ==>Error<==" << '\n';
+        std::cout << "Angle: " << angle << " ==>Error<==" << std::endl;
+      }
+    };
+
+    double     previous_angle = 45.0;
+    ShotResult previous_shot  = shootWithSensitivities( previous_angle );
+    report( previous_angle, previous_shot );
+
+    double     best_angle = std::clamp( previous_angle + std::copysign( angle_step, previous_shot.d_angle ), min_angle, max_angle );
+    ShotResult best_shot  = shootWithSensitivities( best_angle );
+    report( best_angle, best_shot );
+
+    for ( int iteration = 0; iteration < max_iterations; ++iteration )
     {
-      for ( auto [angle, distance, t] : result_block )
+      double curvature = ( best_shot.d_angle - previous_shot.d_angle ) / ( best_angle - previous_angle );
+
+      double next_angle = curvature < 0.0 ? best_angle - best_shot.d_angle / curvature
+                                          : best_angle + std::copysign( angle_step, best_shot.d_angle );
+      next_angle        = std::clamp( next_angle, min_angle, max_angle );
+
+      if ( std::abs( next_angle - best_angle ) < angle_tolerance )
       {
-        if ( t != 0.0 )
-        {
-          file << "Angle: " << angle << " Distance: " << distance << " Time: " << t << '\n';
-          std::cout << "Angle: " << angle << " Distance: " << distance << " Time: " << t << std::endl;
-        }
-        else
-        {
-          file << "Angle: " << angle << " ==>Error<==" << '\n';
-          std::cout << "Angle: " << angle << " ==>Error<==" << std::endl;
-        }
-
-        if ( distance > best_distance )
-        {
-          best_distance = distance;
-          best_angle    = angle;
-        }
+        break;
       }
+
+      previous_angle = best_angle;
+      previous_shot  = best_shot;
+      best_angle     = next_angle;
+      best_shot      = shootWithSensitivities( best_angle );
+      report( best_angle, best_shot );
     }
 
+    double best_distance = best_shot.distance;
+
     file << "\nOverall ======================================\n";
     file << "Best angle: " << best_angle << " Best distance: " << best_distance << '\n';
     file.close();
 
-    // Dump best trajectory
+    // Dump best trajectory (assets/CBPlotCreator.py reads both files)
     file.open( "./../data/Cannon_best_angle_data.json", std::ios::out );
     file << "{\n";
     file << "  \"angle\": " << best_angle << ",\n";
     file << "  \"distance\": " << best_distance << ",\n";
-    file << "  \"data\": [\n";
-
-    shootWithAngle( file, best_angle );
-
-    file << "  ]\n";
+    file << "  \"trajectory\": \"Cannon_best_angle_trajectory.bin\"\n";
     file << "}\n";
     file.close();
 
+    shootWithAngle( "./../data/Cannon_best_angle_trajectory.bin", best_angle );
+
     return best_angle;
   }
 } // namespace ADAAI::Integration::Cannon
@@ -1,7 +1,10 @@
 #pragma once
 
 #include "../environment/ComputeFunctions.hpp"
+#include "../intergartor/Event.hpp"
 #include "../intergartor/Observer.hpp"
+#include "../intergartor/Sensitivity.hpp"
+#include "../intergartor/TrajectoryWriter.hpp"
 
 /// Integrator implementation for the cannonball problem
 
@@ -42,61 +45,39 @@ namespace ADAAI::Integration::CannonBall
     }
   };
 
+  /// \brief The ball with the sensitivities to the initial angle and velocity (the state starts with x, y, v_x, v_y)
+  using BallSensitivityRHS = Integrator::SensitivityRHS<BallRHS, 2>;
+
+  /// \brief The ground impact (y = 0 while falling), stops the integration exactly at the impact point
+  /// \tparam RHS_T The ball or the ball with the sensitivities
+  template<typename RHS_T = BallRHS>
+  inline Integrator::Event<RHS_T> GroundImpactEvent()
+  {
+    return {
+        []( [[maybe_unused]] double current_time, const double* current_state )
+        {
+          return current_state[1];
+        },
+        Integrator::EventDirection::Decreasing,
+        true };
+  }
+
   struct BallObserver : Integrator::Observer<BallRHS>
   {
-    bool operator()( double current_time, const double current_state[BallRHS::N] ) const override
+    bool operator()( [[maybe_unused]] double current_time, const double current_state[BallRHS::N] ) const override
     {
-      if ( current_time <= 1.0 )
-        return true;
-      return current_state[1] > 100.0; // Optimal to not underground calculation in RHS
+      return current_state[1] >= 0.0; // The integration is stopped by GroundImpactEvent, this is a safeguard only
     }
   };
 
-  struct BallDumperObserver : Integrator::Observer<BallRHS>
+  struct BallSensitivityObserver : Integrator::Observer<BallSensitivityRHS>
   {
-    std::ostream& m_os;
-
-    explicit BallDumperObserver( std::ostream& os )
-        : m_os( os )
-    {
-    }
-
-    bool operator()( double current_time, const double current_state[BallRHS::N] ) const override
+    bool operator()( [[maybe_unused]] double current_time, const double current_state[BallSensitivityRHS::N] ) const override
     {
-      static int ind = 0;
-
-      if ( ( ind++ ) % 10 == 0 )
-      {
-        try
-        {
-          double rhs[BallRHS::N] {};
-          BallRHS {}( current_time, current_state, rhs );
-
-          m_os << "    {\n"
-               << "      \"current_time\":" << current_time << ",\n"
-               << "      \"current_state\": {\n"
-               << "        \"x\": " << current_state[0] << ",\n"
-               << "        \"y\": " << current_state[1] << ",\n"
-               << "        \"v_x\": " << current_state[2] << ",\n"
-               << "        \"v_y\": " << current_state[3] << "\n"
-               << "      },\n"
-               << "      \"rhs\": {\n"
-               << "        \"v_x\": " << rhs[0] << ",\n"
-               << "        \"v_y\": " << rhs[1] << ",\n"
-               << "        \"a_x\": " << rhs[2] << ",\n"
-               << "        \"a_y\": " << rhs[3] << "\n"
-               << "      }\n"
-               << "    },\n";
-        }
-        catch ( ... )
-        {
-          std::cout << "Error in BallDumperObserver" << std::endl;
-        }
-      }
-
-      if ( current_time <= 1.0 )
-        return true;
-      return current_state[1] > 100.0; // Optimal to not underground calculation in RHS
+      return current_state[1] >= 0.0; // The integration is stopped by GroundImpactEvent, this is a safeguard only
     }
   };
+
+  /// \brief Writes every 10th state with the RHS to a trajectory file
+  using BallDumperObserver = Integrator::TrajectoryObserver<BallRHS, BallObserver>;
 } // namespace ADAAI::Integration::CannonBall
@@ -68,7 +68,8 @@ namespace ADAAI::Integration::Environment
       {
         const Layer& layer = layers[l_id];
 
-        if ( h < layer.min_height || h > layer.max_height )
+        // The troposphere is extended below the sea level (trial states of the ground impact step may be there)
+        if ( ( l_id != 0 && h < layer.min_height ) || h > layer.max_height )
         {
           continue;
         }
@@ -90,7 +91,8 @@ namespace ADAAI::Integration::Environment
       {
         const Layer& layer = layers[l_id];
 
-        if ( h < layer.min_height || h > layer.max_height )
+        // The troposphere is extended below the sea level (trial states of the ground impact step may be there)
+        if ( ( l_id != 0 && h < layer.min_height ) || h > layer.max_height )
         {
           continue;
         }
@@ -22,7 +22,9 @@ namespace ADAAI::Integration::Environment
   constexpr double Re = 6378.137f; // Earth's radius (km)
   constexpr double J2 = 1.0827e-3; // J2 perturbation coefficient
 
-  void ComputeUGradient( const double* position, double* u_gradient )
+  /// \brief Computes the gravitational potential energy per unit mass (U0 + U2, the gradient is 'ComputeUGradient')
+  /// \param j2 The J2 coefficient (0 for the Kepler problem)
+  double ComputeU( const double* position, double j2 = J2 )
   {
     double
         x = position[0],
@@ -33,17 +35,41 @@ namespace ADAAI::Integration::Environment
         r2 = x * x + y * y + z * z,
         r  = std::sqrt( r2 ),
         r3 = r2 * r,
+        r5 = r3 * r2;
+
+    double u2_coefficient = j2 * Mu * Re * Re / 2.0;
+
+    return -Mu / r + u2_coefficient * ( 3.0 * z * z / r5 - 1.0 / r3 );
+  }
+
+  /// \brief Computes the gradient of U (the acceleration is minus it)
+  /// \tparam T double or an AD type (e.g. 'Diff::AAD::TaylorNode' for the Taylor stepper)
+  /// \param j2 The J2 coefficient (0 for the Kepler problem)
+  template<typename T>
+  void ComputeUGradient( const T* position, T* u_gradient, double j2 = J2 )
+  {
+    using std::sqrt;
+
+    T
+        x = position[0],
+        y = position[1],
+        z = position[2];
+
+    T
+        r2 = x * x + y * y + z * z,
+        r  = sqrt( r2 ),
+        r3 = r2 * r,
         r5 = r3 * r2,
         r7 = r5 * r2;
 
-    double u0_gradient = -Mu / r3; // there is forgotten x/y/z in dr/dr replacement
+    T u0_gradient = -Mu / r3; // there is forgotten x/y/z in dr/dr replacement
 
-    double u2_coefficient = J2 * Mu * Re * Re / 2.0;
-    double
+    double u2_coefficient = j2 * Mu * Re * Re / 2.0;
+    T
         u2_general_gradient    = -3.0 / r5,                         // there is forgotten x/y/z in dr/d(x/y/z) replacement
         u2_special_xy_gradient = -15.0 * z * z / r7,                // there is forgotten x/y/z in dr/d(x/y/z) replacement
         u2_special_z_gradient  = u2_special_xy_gradient + 6.0 / r5; // there is forgotten z in d(z^2)/dz replacement
-    double
+    T
         u2_xy_summary = u0_gradient - u2_coefficient * ( u2_special_xy_gradient - u2_general_gradient ),
         u2_z_summary  = u0_gradient - u2_coefficient * ( u2_special_z_gradient - u2_general_gradient );
 
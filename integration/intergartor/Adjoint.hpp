@@ -0,0 +1,248 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "RHS.hpp"
+
+namespace ADAAI::Integration::Integrator
+{
+  /// \brief An RHS with NP parameters p that supplies the vector-Jacobian products:
+  ///        'void vjp( double t, const double* y, const double* lambda, double* w_y, double* w_p ) const'
+  ///        computes w_y = lambda^T df/dy and w_p = lambda^T df/dp at (t, y)
+  template<typename RHS_I>
+  concept AdjointRHS = requires( const RHS_I& rhs, double t, const double* y, const double* lambda, double* w_y, double* w_p ) {
+    { RHS_I::NP } -> std::convertible_to<int>;
+    rhs.vjp( t, y, lambda, w_y, w_p );
+  };
+
+  /// \brief The discrete adjoint of the classic fixed step RK4 with the binomial checkpointing
+  /// \details 'forward' integrates the system and keeps the initial state only. 'backward' propagates the gradient
+  ///          of an objective J(y(t_end)) back to the initial state and accumulates the gradient with respect to the
+  ///          parameters of the RHS. The states are recomputed from the checkpoints placed by the binomial schedule
+  ///          (A. Griewank, A. Walther, "revolve", ACM TOMS 26, 2000): with s checkpoints n steps are reversed with
+  ///          r forward repetitions, where r is minimal with C(s + r, s) >= n. The memory is s states
+  ///          and all of the parameter gradients cost one backward sweep (4 vector-Jacobian products per step).
+  ///          The gradients are exact for the discrete RK4 solution.
+  template<typename RHS_I>
+    requires AdjointRHS<RHS_I>
+  class AdjointRK4_Integrator
+  {
+    constexpr static int N = RHS_I::N;
+
+    const RHS_I* m_rhs;
+    int          m_snapshots;
+
+    mutable std::vector<double> m_checkpoints; // m_snapshots states
+
+    // The forward integration
+    mutable double m_t_start = 0.0;
+    mutable double m_h       = 0.0;
+    mutable int    m_steps   = 0;
+    mutable double m_y0[N] {};
+
+    mutable long m_forward_steps = 0; // The forward steps (including the recomputations) of the last integration
+
+    /// \brief The most steps reversible with s checkpoints and r repetitions: C(s + r, s)
+    static long long reversible_steps( int s, int r )
+    {
+      long long result = 1;
+      for ( int i = 1; i <= std::min( s, r ); ++i )
+      {
+        result = result * ( s + r - std::min( s, r ) + i ) / i;
+        if ( result > ( 1LL << 40 ) )
+        {
+          return 1LL << 40;
+        }
+      }
+      return result;
+    }
+
+    /// \brief Advances the state y from step 'first' to step 'last'
+    void advance( int first, int last, double* y ) const
+    {
+      double k[N];
+      double stage[N];
+      double sum[N];
+
+      for ( int step = first; step < last; ++step )
+      {
+        double t = m_t_start + step * m_h;
+
+        ( *m_rhs )( t, y, k );
+        for ( int i = 0; i < N; ++i )
+        {
+          sum[i]   = k[i];
+          stage[i] = y[i] + m_h / 2.0 * k[i];
+        }
+
+        ( *m_rhs )( t + m_h / 2.0, stage, k );
+        for ( int i = 0; i < N; ++i )
+        {
+          sum[i] += 2.0 * k[i];
+          stage[i] = y[i] + m_h / 2.0 * k[i];
+        }
+
+        ( *m_rhs )( t + m_h / 2.0, stage, k );
+        for ( int i = 0; i < N; ++i )
+        {
+          sum[i] += 2.0 * k[i];
+          stage[i] = y[i] + m_h * k[i];
+        }
+
+        ( *m_rhs )( t + m_h, stage, k );
+        for ( int i = 0; i < N; ++i )
+        {
+          y[i] += m_h / 6.0 * ( sum[i] + k[i] );
+        }
+
+        m_forward_steps++;
+      }
+    }
+
+    /// \brief The adjoint of the step 'step' from the state y: lambda_n = lambda_(n+1) + sum of Y_i^T, dJ/dp += sum of P_i^T
+    void adjoint_step( int step, const double* y, double* lambda, double* dJ_dp ) const
+    {
+      const double t = m_t_start + step * m_h;
+
+      const double stage_times[4] = { t, t + m_h / 2.0, t + m_h / 2.0, t + m_h };
+      const double a[4]           = { 0.0, m_h / 2.0, m_h / 2.0, m_h }; // Y_i = y + a_i k_(i-1)
+      const double b[4]           = { m_h / 6.0, m_h / 3.0, m_h / 3.0, m_h / 6.0 };
+
+      // The stages are recomputed
+      std::vector<double> stages( 4 * N );
+      double              k[N];
+      for ( int s = 0; s < 4; ++s )
+      {
+        double* Y = stages.data() + s * N;
+        for ( int i = 0; i < N; ++i )
+        {
+          Y[i] = y[i] + ( s == 0 ? 0.0 : a[s] * k[i] );
+        }
+        ( *m_rhs )( stage_times[s], Y, k );
+      }
+
+      // k_bar_i = b_i lambda + a_(i+1) Y_bar_(i+1), Y_bar_i = k_bar_i^T df/dy (Y_i)
+      double k_bar[N];
+      double Y_bar[N];
+      double lambda_sum[N];
+      double w_p[RHS_I::NP > 0 ? RHS_I::NP : 1];
+
+      std::memcpy( lambda_sum, lambda, sizeof( lambda_sum ) );
+      for ( int s = 3; s >= 0; --s )
+      {
+        for ( int i = 0; i < N; ++i )
+        {
+          k_bar[i] = b[s] * lambda[i] + ( s == 3 ? 0.0 : a[s + 1] * Y_bar[i] );
+        }
+
+        m_rhs->vjp( stage_times[s], stages.data() + s * N, k_bar, Y_bar, w_p );
+
+        for ( int i = 0; i < N; ++i )
+        {
+          lambda_sum[i] += Y_bar[i];
+        }
+        for ( int p = 0; p < RHS_I::NP; ++p )
+        {
+          dJ_dp[p] += w_p[p];
+        }
+      }
+
+      std::memcpy( lambda, lambda_sum, sizeof( lambda_sum ) );
+    }
+
+    /// \brief Reverses the steps [first, last) from the state at 'first' with 'free' unused checkpoints
+    void reverse( int first, int last, int free, const double* y_first, double* lambda, double* dJ_dp ) const
+    {
+      const int n = last - first;
+
+      if ( n == 1 )
+      {
+        adjoint_step( first, y_first, lambda, dJ_dp );
+        return;
+      }
+
+      if ( free == 0 )
+      {
+        // No checkpoints: every state is recomputed from 'first'
+        std::vector<double> y( N );
+        for ( int step = last - 1; step >= first; --step )
+        {
+          std::copy( y_first, y_first + N, y.begin() );
+          advance( first, step, y.data() );
+          adjoint_step( step, y.data(), lambda, dJ_dp );
+        }
+        return;
+      }
+
+      int repetitions = 1;
+      while ( reversible_steps( free, repetitions ) < n )
+      {
+        ++repetitions;
+      }
+
+      // The right part fits into the remaining checkpoints with the same repetitions, the left part with one less
+      int middle = first + std::max<int>( 1, static_cast<int>( n - std::min<long long>( n, reversible_steps( free - 1, repetitions ) ) ) );
+
+      double* checkpoint = m_checkpoints.data() + static_cast<std::size_t>( m_snapshots - free ) * N;
+      std::copy( y_first, y_first + N, checkpoint );
+      advance( first, middle, checkpoint );
+
+      reverse( middle, last, free - 1, checkpoint, lambda, dJ_dp );
+      reverse( first, middle, free, y_first, lambda, dJ_dp );
+    }
+
+  public:
+    /// \param rhs The right-hand side of the system
+    /// \param snapshots The number of the checkpoints (the states kept in memory)
+    explicit AdjointRK4_Integrator( const RHS_I* rhs, int snapshots = 32 )
+        : m_rhs( rhs ), m_snapshots( snapshots ), m_checkpoints( static_cast<std::size_t>( snapshots ) * N )
+    {
+      if ( snapshots < 0 )
+      {
+        throw std::invalid_argument( "AdjointRK4_Integrator: The number of the checkpoints must be non-negative" );
+      }
+    }
+
+    /// \brief The forward steps (including the recomputations) since the last 'forward'
+    [[nodiscard]] long forwardSteps() const
+    {
+      return m_forward_steps;
+    }
+
+    /// \brief Integrates the system with 'steps' RK4 steps
+    /// \param state_start The initial state of the system
+    /// \param state_end The final state of the system
+    void forward( const double state_start[N], double state_end[N], double t_start, double t_end, int steps ) const
+    {
+      if ( steps <= 0 )
+      {
+        throw std::invalid_argument( "AdjointRK4_Integrator: The number of the steps must be positive" );
+      }
+
+      m_t_start       = t_start;
+      m_h             = ( t_end - t_start ) / steps;
+      m_steps         = steps;
+      m_forward_steps = 0;
+      std::memcpy( m_y0, state_start, sizeof( m_y0 ) );
+
+      std::memcpy( state_end, state_start, sizeof( m_y0 ) );
+      advance( 0, steps, state_end );
+    }
+
+    /// \brief Propagates the gradient of J(y(t_end)) back through the last 'forward' integration
+    /// \param dJ_dy_end The gradient of the objective with respect to the final state
+    /// \param dJ_dy_start The gradient with respect to the initial state
+    /// \param dJ_dp The gradient with respect to the parameters of the RHS
+    void backward( const double dJ_dy_end[N], double dJ_dy_start[N], double dJ_dp[RHS_I::NP] ) const
+    {
+      std::memcpy( dJ_dy_start, dJ_dy_end, sizeof( m_y0 ) );
+      std::fill( dJ_dp, dJ_dp + RHS_I::NP, 0.0 );
+
+      reverse( 0, m_steps, m_snapshots, m_y0, dJ_dy_start, dJ_dp );
+    }
+  }; // class AdjointRK4_Integrator
+} // namespace ADAAI::Integration::Integrator
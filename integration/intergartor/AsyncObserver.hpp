@@ -0,0 +1,322 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Observer.hpp"
+
+namespace ADAAI::Integration::Integrator
+{
+  /// \brief A lock-free ring buffer for one producer thread and one consumer thread
+  /// \details The slots are filled and read in place (no copies of the records through the interface).
+  ///          The indices grow monotonically, the slot is index & (capacity - 1).
+  template<typename T>
+  class SpscRingBuffer
+  {
+    std::vector<T> m_slots;
+    std::size_t    m_mask;
+
+    alignas( 64 ) std::atomic<std::size_t> m_head { 0 }; // The next slot to read (written by the consumer)
+    alignas( 64 ) std::atomic<std::size_t> m_tail { 0 }; // The next slot to write (written by the producer)
+
+    static std::size_t round_up( std::size_t capacity )
+    {
+      std::size_t result = 1;
+      while ( result < capacity )
+      {
+        result *= 2;
+      }
+      return result;
+    }
+
+  public:
+    /// \param capacity The number of the slots (rounded up to a power of two)
+    explicit SpscRingBuffer( std::size_t capacity )
+        : m_slots( round_up( capacity ) ), m_mask( round_up( capacity ) - 1 )
+    {
+    }
+
+    [[nodiscard]] std::size_t capacity() const
+    {
+      return m_slots.size();
+    }
+
+    /// \brief If there is no slot to read (exact for the consumer)
+    [[nodiscard]] bool empty() const
+    {
+      return m_head.load( std::memory_order_acquire ) == m_tail.load( std::memory_order_acquire );
+    }
+
+    /// \brief If there is no slot to write (exact for the producer)
+    [[nodiscard]] bool full() const
+    {
+      return m_tail.load( std::memory_order_acquire ) - m_head.load( std::memory_order_acquire ) == m_slots.size();
+    }
+
+    /// \brief Fills the next slot with 'fill( T& )' if there is one (the producer only)
+    template<typename Fill>
+    bool try_push( Fill&& fill )
+    {
+      std::size_t tail = m_tail.load( std::memory_order_relaxed );
+      if ( tail - m_head.load( std::memory_order_acquire ) == m_slots.size() )
+      {
+        return false;
+      }
+
+      std::forward<Fill>( fill )( m_slots[tail & m_mask] );
+      m_tail.store( tail + 1, std::memory_order_release );
+      return true;
+    }
+
+    /// \brief Passes the oldest slot to 'use( const T& )' if there is one (the consumer only)
+    template<typename Use>
+    bool try_pop( Use&& use )
+    {
+      std::size_t head = m_head.load( std::memory_order_relaxed );
+      if ( head == m_tail.load( std::memory_order_acquire ) )
+      {
+        return false;
+      }
+
+      std::forward<Use>( use )( std::as_const( m_slots[head & m_mask] ) );
+      m_head.store( head + 1, std::memory_order_release );
+      return true;
+    }
+  }; // class SpscRingBuffer
+
+  /// \brief What the asynchronous observer does if the consumer falls behind
+  enum class BackpressurePolicy
+  {
+    Block,   // The integration waits for a free slot (nothing is lost)
+    Drop,    // The record is dropped
+    Decimate // The record is dropped and only every 2nd (4th, 8th, ...) record is queued from now on
+  };
+
+  /// \brief Hands the observed states to a consumer thread
+  /// \details The wrapped observer decides synchronously if the integration goes on, the states are copied
+  ///          into a ring buffer and 'consumer( t, state )' is called for them on its own thread, so the I/O
+  ///          and the analysis don't stall the steps. 'finish' (or the destructor) drains the buffer.
+  ///          The consumer waiting for a record (and the producer waiting for a slot with Block) sleeps on a
+  ///          condition variable. The other side takes the mutex to wake it only if it sleeps, so the records
+  ///          pass through the ring buffer without locks.
+  /// \tparam RHS_O The observer deciding if the integration goes on
+  template<typename RHS_I, typename RHS_O>
+    requires std::is_base_of_v<Observer<RHS_I>, RHS_O>
+  class AsyncObserver : public Observer<RHS_I>
+  {
+  public:
+    using Consumer = std::function<void( double, const double* )>;
+
+  private:
+    struct Record
+    {
+      double time;
+      double state[RHS_I::N];
+    };
+
+    RHS_O              m_observer;
+    Consumer           m_consumer;
+    BackpressurePolicy m_policy;
+
+    mutable SpscRingBuffer<Record> m_buffer;
+
+    // The producer side
+    mutable long m_observed   = 0;
+    mutable long m_dropped    = 0;
+    mutable long m_decimation = 1;
+
+    std::atomic<bool>  m_done { false };
+    std::atomic<bool>  m_failed { false }; // The consumer has thrown
+    std::exception_ptr m_consumer_exception;
+
+    mutable std::mutex              m_mutex;
+    mutable std::condition_variable m_condition;
+    mutable std::atomic<bool>       m_consumer_waiting { false };
+    mutable std::atomic<bool>       m_producer_waiting { false };
+
+    std::thread m_thread;
+
+    /// \brief Sleeps until 'ready()' (checked after 'waiting' is raised, so the wake-up is not missed)
+    template<typename Ready>
+    void sleep( std::atomic<bool>& waiting, Ready ready ) const
+    {
+      std::unique_lock lock( m_mutex );
+      waiting.store( true, std::memory_order_relaxed );
+      std::atomic_thread_fence( std::memory_order_seq_cst );
+      m_condition.wait( lock, ready );
+      waiting.store( false, std::memory_order_relaxed );
+    }
+
+    /// \brief Wakes the other side if it sleeps (after the push or the pop it waits for)
+    void wake( const std::atomic<bool>& waiting ) const
+    {
+      std::atomic_thread_fence( std::memory_order_seq_cst );
+      if ( waiting.load( std::memory_order_relaxed ) )
+      {
+        std::lock_guard lock( m_mutex );
+        m_condition.notify_all();
+      }
+    }
+
+    /// \brief Wakes both sides after m_done or m_failed is set
+    void wake_all() const
+    {
+      std::lock_guard lock( m_mutex );
+      m_condition.notify_all();
+    }
+
+    void consume()
+    {
+      auto use = [this]( const Record& record )
+      {
+        m_consumer( record.time, record.state );
+      };
+
+      try
+      {
+        while ( true )
+        {
+          if ( m_buffer.try_pop( use ) )
+          {
+            wake( m_producer_waiting );
+            continue;
+          }
+          if ( m_done.load( std::memory_order_acquire ) )
+          {
+            // The producer has stopped: the rest is drained
+            while ( m_buffer.try_pop( use ) )
+            {
+            }
+            return;
+          }
+          sleep( m_consumer_waiting, [this]
+                 { return !m_buffer.empty() || m_done.load( std::memory_order_acquire ); } );
+        }
+      }
+      catch ( ... )
+      {
+        m_consumer_exception = std::current_exception();
+        m_failed.store( true, std::memory_order_release );
+        wake_all();
+      }
+    }
+
+  public:
+    /// \param consumer Receives the states on the consumer thread
+    /// \param observer Decides if the integration goes on
+    /// \param policy What is done if the buffer is full
+    /// \param capacity The number of the records in the buffer
+    explicit AsyncObserver( Consumer consumer, RHS_O observer = RHS_O(), BackpressurePolicy policy = BackpressurePolicy::Block, std::size_t capacity = 4096 )
+        : m_observer( std::move( observer ) ), m_consumer( std::move( consumer ) ), m_policy( policy ), m_buffer( capacity ),
+          m_thread( &AsyncObserver::consume, this )
+    {
+    }
+
+    AsyncObserver( const AsyncObserver& )            = delete;
+    AsyncObserver& operator=( const AsyncObserver& ) = delete;
+
+    ~AsyncObserver()
+    {
+      try
+      {
+        finish();
+      }
+      catch ( ... )
+      {
+      }
+    }
+
+    /// \brief Waits until the consumer has received all of the queued states
+    /// \details Rethrows the exception of the consumer (the consumer stops at it)
+    void finish()
+    {
+      if ( m_thread.joinable() )
+      {
+        m_done.store( true, std::memory_order_release );
+        wake_all();
+        m_thread.join();
+      }
+      if ( m_consumer_exception )
+      {
+        std::rethrow_exception( std::exchange( m_consumer_exception, nullptr ) );
+      }
+    }
+
+    /// \brief The states not passed to the consumer (Drop and Decimate)
+    [[nodiscard]] long dropped() const
+    {
+      return m_dropped;
+    }
+
+    /// \brief Every decimation()-th state is queued (Decimate)
+    [[nodiscard]] long decimation() const
+    {
+      return m_decimation;
+    }
+
+    bool operator()( double current_time, const double current_state[RHS_I::N] ) const override
+    {
+      bool go_on = m_observer( current_time, current_state );
+
+      auto fill = [&]( Record& record )
+      {
+        record.time = current_time;
+        for ( int i = 0; i < RHS_I::N; ++i )
+        {
+          record.state[i] = current_state[i];
+        }
+      };
+
+      if ( m_done.load( std::memory_order_relaxed ) )
+      {
+        throw std::runtime_error( "AsyncObserver: The observer is finished" );
+      }
+
+      if ( ( m_observed++ ) % m_decimation != 0 )
+      {
+        m_dropped++;
+      }
+      else if ( m_buffer.try_push( fill ) )
+      {
+        wake( m_consumer_waiting );
+      }
+      else
+      {
+        switch ( m_policy )
+        {
+          case BackpressurePolicy::Block:
+            while ( !m_buffer.try_push( fill ) )
+            {
+              if ( m_failed.load( std::memory_order_acquire ) )
+              {
+                m_dropped++; // Nobody drains the buffer, 'finish' reports the exception
+                break;
+              }
+              sleep( m_producer_waiting, [this]
+                     { return !m_buffer.full() || m_failed.load( std::memory_order_acquire ); } );
+            }
+            wake( m_consumer_waiting );
+            break;
+          case BackpressurePolicy::Drop:
+            m_dropped++;
+            break;
+          case BackpressurePolicy::Decimate:
+            m_dropped++;
+            m_decimation *= 2;
+            break;
+        }
+      }
+
+      return go_on;
+    }
+  }; // class AsyncObserver
+} // namespace ADAAI::Integration::Integrator
@@ -0,0 +1,253 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ADAAI::Integration::Integrator
+{
+  /// \brief The state of an integration the integrator can resume from (see ODE_Integrator::resume)
+  struct Checkpoint
+  {
+    double              time         = 0.0;
+    double              suggested_dt = 0.0; // The step the integrator would have tried next
+    long                steps        = 0;   // The steps since the start of the integration
+    std::vector<double> state;
+    std::vector<char>   stepper; // The data the stepper carries across the steps (see TimeStepper::save)
+  };
+
+  /// \brief Writes a checkpoint file
+  /// \details The file is written next to 'path' and renamed to it, so an interrupted write keeps the previous checkpoint.
+  ///          The format (native byte order):
+  ///          char magic[8] = "ADAAICKP", uint32 version, uint32 state_size, float64 time, float64 suggested_dt,
+  ///          uint64 steps, uint64 stepper_size, the state (state_size float64) and the stepper bytes.
+  inline void WriteCheckpoint( const std::string& path, const Checkpoint& checkpoint )
+  {
+    constexpr std::uint32_t version = 1;
+
+    std::uint32_t state_size   = checkpoint.state.size();
+    std::uint64_t steps        = checkpoint.steps;
+    std::uint64_t stepper_size = checkpoint.stepper.size();
+
+    const std::string temporary = path + ".tmp";
+    {
+      std::ofstream file( temporary, std::ios::out | std::ios::binary | std::ios::trunc );
+      if ( !file )
+      {
+        throw std::runtime_error( "WriteCheckpoint: Failed to open " + temporary );
+      }
+
+      file.write( "ADAAICKP", 8 );
+      file.write( reinterpret_cast<const char*>( &version ), sizeof( version ) );
+      file.write( reinterpret_cast<const char*>( &state_size ), sizeof( state_size ) );
+      file.write( reinterpret_cast<const char*>( &checkpoint.time ), sizeof( double ) );
+      file.write( reinterpret_cast<const char*>( &checkpoint.suggested_dt ), sizeof( double ) );
+      file.write( reinterpret_cast<const char*>( &steps ), sizeof( steps ) );
+      file.write( reinterpret_cast<const char*>( &stepper_size ), sizeof( stepper_size ) );
+      file.write( reinterpret_cast<const char*>( checkpoint.state.data() ), static_cast<std::streamsize>( state_size * sizeof( double ) ) );
+      file.write( checkpoint.stepper.data(), static_cast<std::streamsize>( stepper_size ) );
+
+      if ( !file.flush() )
+      {
+        throw std::runtime_error( "WriteCheckpoint: Failed to write " + temporary );
+      }
+    }
+
+    if ( std::rename( temporary.c_str(), path.c_str() ) != 0 )
+    {
+      throw std::runtime_error( "WriteCheckpoint: Failed to rename " + temporary + " to " + path );
+    }
+  }
+
+  /// \brief Reads a checkpoint file written by WriteCheckpoint
+  inline Checkpoint ReadCheckpoint( const std::string& path )
+  {
+    std::ifstream file( path, std::ios::in | std::ios::binary );
+    if ( !file )
+    {
+      throw std::runtime_error( "ReadCheckpoint: Failed to open " + path );
+    }
+
+    char          magic[8];
+    std::uint32_t version      = 0;
+    std::uint32_t state_size   = 0;
+    std::uint64_t steps        = 0;
+    std::uint64_t stepper_size = 0;
+    Checkpoint    checkpoint;
+
+    file.read( magic, 8 );
+    file.read( reinterpret_cast<char*>( &version ), sizeof( version ) );
+    if ( !file || std::memcmp( magic, "ADAAICKP", 8 ) != 0 || version != 1 )
+    {
+      throw std::runtime_error( "ReadCheckpoint: " + path + " is not a checkpoint file" );
+    }
+
+    file.read( reinterpret_cast<char*>( &state_size ), sizeof( state_size ) );
+    file.read( reinterpret_cast<char*>( &checkpoint.time ), sizeof( double ) );
+    file.read( reinterpret_cast<char*>( &checkpoint.suggested_dt ), sizeof( double ) );
+    file.read( reinterpret_cast<char*>( &steps ), sizeof( steps ) );
+    file.read( reinterpret_cast<char*>( &stepper_size ), sizeof( stepper_size ) );
+    if ( !file )
+    {
+      throw std::runtime_error( "ReadCheckpoint: " + path + " is truncated" );
+    }
+
+    checkpoint.steps = static_cast<long>( steps );
+    checkpoint.state.resize( state_size );
+    checkpoint.stepper.resize( stepper_size );
+    file.read( reinterpret_cast<char*>( checkpoint.state.data() ), static_cast<std::streamsize>( state_size * sizeof( double ) ) );
+    file.read( checkpoint.stepper.data(), static_cast<std::streamsize>( stepper_size ) );
+    if ( !file )
+    {
+      throw std::runtime_error( "ReadCheckpoint: " + path + " is truncated" );
+    }
+
+    return checkpoint;
+  }
+
+  /// \brief Writes the checkpoints of an integration on its own thread
+  /// \details 'submit' only hands the checkpoint over, so the steps are not stalled by the file system.
+  ///          If the thread is still writing, a newer checkpoint replaces the waiting one (only the latest matters).
+  class CheckpointWriter
+  {
+    std::string m_path;
+
+    std::mutex              m_mutex;
+    std::condition_variable m_condition;
+    Checkpoint              m_pending;
+    bool                    m_has_pending = false;
+    bool                    m_done        = false;
+    long                    m_written     = 0;
+    long                    m_skipped     = 0;
+    std::exception_ptr      m_exception;
+
+    std::thread m_thread;
+
+    void write_loop()
+    {
+      Checkpoint checkpoint;
+      while ( true )
+      {
+        {
+          std::unique_lock lock( m_mutex );
+          m_condition.wait( lock, [this]
+                            { return m_has_pending || m_done; } );
+          if ( !m_has_pending )
+          {
+            return;
+          }
+          std::swap( checkpoint, m_pending ); // The buffers of the previous checkpoint are reused by 'submit'
+          m_has_pending = false;
+        }
+
+        try
+        {
+          WriteCheckpoint( m_path, checkpoint );
+        }
+        catch ( ... )
+        {
+          std::lock_guard lock( m_mutex );
+          m_exception = std::current_exception();
+          return;
+        }
+
+        std::lock_guard lock( m_mutex );
+        m_written++;
+      }
+    }
+
+  public:
+    /// \param path The checkpoint file (replaced by every checkpoint)
+    explicit CheckpointWriter( std::string path )
+        : m_path( std::move( path ) ), m_thread( &CheckpointWriter::write_loop, this )
+    {
+    }
+
+    CheckpointWriter( const CheckpointWriter& )            = delete;
+    CheckpointWriter& operator=( const CheckpointWriter& ) = delete;
+
+    ~CheckpointWriter()
+    {
+      try
+      {
+        finish();
+      }
+      catch ( ... )
+      {
+      }
+    }
+
+    [[nodiscard]] const std::string& path() const
+    {
+      return m_path;
+    }
+
+    /// \brief Queues a checkpoint for writing
+    /// \details Rethrows the exception of a failed write
+    void submit( double time, double suggested_dt, long steps, const double* state, std::size_t state_size, const std::vector<char>& stepper )
+    {
+      std::lock_guard lock( m_mutex );
+      if ( m_exception )
+      {
+        std::rethrow_exception( m_exception );
+      }
+      if ( m_done )
+      {
+        throw std::runtime_error( "CheckpointWriter: The writer is finished" );
+      }
+
+      m_skipped += m_has_pending ? 1 : 0;
+
+      m_pending.time         = time;
+      m_pending.suggested_dt = suggested_dt;
+      m_pending.steps        = steps;
+      m_pending.state.assign( state, state + state_size );
+      m_pending.stepper.assign( stepper.begin(), stepper.end() );
+      m_has_pending = true;
+
+      m_condition.notify_one();
+    }
+
+    /// \brief Writes the waiting checkpoint and stops the thread
+    /// \details Rethrows the exception of a failed write
+    void finish()
+    {
+      if ( m_thread.joinable() )
+      {
+        {
+          std::lock_guard lock( m_mutex );
+          m_done = true;
+        }
+        m_condition.notify_one();
+        m_thread.join();
+      }
+      if ( m_exception )
+      {
+        std::rethrow_exception( std::exchange( m_exception, nullptr ) );
+      }
+    }
+
+    /// \brief The checkpoints written so far
+    [[nodiscard]] long written()
+    {
+      std::lock_guard lock( m_mutex );
+      return m_written;
+    }
+
+    /// \brief The checkpoints replaced by a newer one before they were written
+    [[nodiscard]] long skipped()
+    {
+      std::lock_guard lock( m_mutex );
+      return m_skipped;
+    }
+  }; // class CheckpointWriter
+} // namespace ADAAI::Integration::Integrator
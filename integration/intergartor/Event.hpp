@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cmath>
+#include <functional>
+#include <vector>
+
+#include "../../utils/Consts.hpp"
+
+namespace ADAAI::Integration::Integrator
+{
+  /// \brief The direction of the zero crossing an event reacts to
+  enum class EventDirection : int
+  {
+    Decreasing = -1, // g goes from positive to non-positive
+    Any        = 0,
+    Increasing = 1, // g goes from negative to non-negative
+  };
+
+  /// \brief An event is a zero crossing of the function g(t, y)
+  template<typename RHS>
+  struct Event
+  {
+    std::function<double( double, const double* )> g; // The event function g(t, y)
+
+    EventDirection direction = EventDirection::Any;
+    bool           terminal  = false; // If true the integration stops at the event
+  };
+
+  /// \brief A located event
+  struct EventRecord
+  {
+    std::size_t         event_id; // The index of the event (in order of addition)
+    double              time;     // The time of the zero crossing
+    std::vector<double> state;    // The state at the zero crossing
+  };
+
+  /// \brief Checks if the change of g from g_prev to g_next is a crossing in the given direction
+  inline bool IsEventCrossing( EventDirection direction, double g_prev, double g_next )
+  {
+    bool increasing = g_prev < 0.0 && g_next >= 0.0;
+    bool decreasing = g_prev > 0.0 && g_next <= 0.0;
+
+    switch ( direction )
+    {
+      case EventDirection::Decreasing:
+        return decreasing;
+      case EventDirection::Increasing:
+        return increasing;
+      case EventDirection::Any:
+        return increasing || decreasing;
+    }
+
+    return false;
+  }
+
+  /// \brief Finds the root of f in [a, b] with the Illinois (modified regula falsi) method
+  /// \param f The function (f(a) and f(b) must have different signs or f(b) = 0)
+  /// \param a, b The bracket
+  /// \param f_a, f_b The values of f at a and b
+  /// \return The root (as the right end of the final bracket, so the crossing is always reached)
+  template<typename Callable>
+  double FindRootIllinois( const Callable& f, double a, double b, double f_a, double f_b )
+  {
+    const int max_iterations = 100;
+
+    int side = 0; // Which end was kept on the previous iteration
+
+    for ( int iteration = 0; iteration < max_iterations; ++iteration )
+    {
+      if ( f_b == 0.0 || std::abs( b - a ) <= 4.0 * CONST::EPS<double> * std::max( std::abs( a ), std::abs( b ) ) )
+      {
+        break;
+      }
+
+      double c   = ( a * f_b - b * f_a ) / ( f_b - f_a );
+      double f_c = f( c );
+
+      if ( f_c == 0.0 )
+      {
+        return c;
+      }
+
+      if ( ( f_c > 0.0 ) == ( f_b > 0.0 ) )
+      {
+        b   = c;
+        f_b = f_c;
+        if ( side == -1 )
+        {
+          f_a /= 2.0;
+        }
+        side = -1;
+      }
+      else
+      {
+        a   = c;
+        f_a = f_c;
+        if ( side == 1 )
+        {
+          f_b /= 2.0;
+        }
+        side = 1;
+      }
+    }
+
+    return b;
+  }
+} // namespace ADAAI::Integration::Integrator
@@ -1,8 +1,14 @@
 #pragma once
 
-#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
 
+#include "Checkpoint.hpp"
+#include "Event.hpp"
 #include "Observer.hpp"
+#include "Progress.hpp"
+#include "Statistics.hpp"
 #include "steppers/RFK45_TimeStepper.hpp"
 
 namespace ADAAI::Integration::Integrator
@@ -19,10 +25,97 @@ namespace ADAAI::Integration::Integrator
     const TS*    m_stepper;
     const RHS_O* m_observer;
 
+    std::vector<double> m_output_times; // If not empty the observer is called only at these times
+    std::vector<double> m_stop_times;   // The steps land exactly on these times (the discontinuities of the RHS)
+
+    constexpr static double stop_tolerance = 1e-8; // A step missing a stop time by less than this fraction is stretched to it
+
+    std::vector<Event<RHS_I>>        m_events;
+    mutable std::vector<EventRecord> m_triggered_events;
+
+    const ProgressSink* m_progress = nullptr; // The progress is not reported by default
+
+    CheckpointWriter* m_checkpoints         = nullptr; // The checkpoints are not written by default
+    long              m_checkpoint_interval = 0;
+
+    mutable IntegrationStats m_stats;
+
   public:
     ODE_Integrator( const TS* stepper, const RHS_O* observer )
         : m_stepper( stepper ), m_observer( observer )
     {
+      if constexpr ( BreakpointRHS<RHS_I> )
+      {
+        m_stop_times.assign( RHS_I::breakpoints.begin(), RHS_I::breakpoints.end() );
+        std::sort( m_stop_times.begin(), m_stop_times.end() );
+      }
+    }
+
+    /// \brief Sets the times at which the observer is called
+    /// \details The states at these times are taken from the dense output of the stepper,
+    ///          so the step size is not limited by the output resolution.
+    ///          Passing an empty vector restores the observation at every step.
+    /// \param output_times The times of observation
+    void setOutputTimes( std::vector<double> output_times )
+    {
+      m_output_times = std::move( output_times );
+      std::sort( m_output_times.begin(), m_output_times.end() );
+    }
+
+    /// \brief Adds the times the steps must land on exactly (tstops)
+    /// \details The breakpoints declared by the RHS (see BreakpointRHS) are added automatically.
+    ///          The stepper is reset at a stop time, so the step after it doesn't reuse the data
+    ///          from the other side of a discontinuity (FSAL, multistep history). A fixed step is cut
+    ///          at a stop time and continues with the same size after it.
+    /// \param stop_times The times to add
+    void addStopTimes( const std::vector<double>& stop_times )
+    {
+      m_stop_times.insert( m_stop_times.end(), stop_times.begin(), stop_times.end() );
+      std::sort( m_stop_times.begin(), m_stop_times.end() );
+      m_stop_times.erase( std::unique( m_stop_times.begin(), m_stop_times.end() ), m_stop_times.end() );
+    }
+
+    /// \brief The statistics of the last integration (empty if INTEGRATION_NO_STATS is defined)
+    [[nodiscard]] const IntegrationStats& statistics() const
+    {
+      return m_stats;
+    }
+
+    /// \brief Sets the sink of the progress (the steps, the RHS calls, the rejections and the step size)
+    /// \param progress The sink, nullptr disables the reporting
+    void setProgressSink( const ProgressSink* progress )
+    {
+      m_progress = progress;
+    }
+
+    /// \brief Writes a checkpoint (the time, the state, the next step and the data of the stepper) every few steps
+    /// \details The checkpoint is copied at the end of the step and written on the thread of the writer.
+    ///          The events located before the checkpoint are not a part of it.
+    /// \param checkpoints The writer, nullptr disables the checkpoints
+    /// \param interval The steps between the checkpoints
+    void setCheckpoints( CheckpointWriter* checkpoints, long interval = 10000 )
+    {
+      if ( interval <= 0 )
+      {
+        throw std::invalid_argument( "ODE_Integrator: The checkpoint interval must be positive" );
+      }
+      m_checkpoints         = checkpoints;
+      m_checkpoint_interval = interval;
+    }
+
+    /// \brief Adds an event that is located precisely (using the dense output of the stepper)
+    /// \details Terminal events stop the integration at the zero crossing, all of
+    ///          the located events are available through 'triggeredEvents' afterwards
+    /// \param event The event to add
+    void addEvent( Event<RHS_I> event )
+    {
+      m_events.push_back( std::move( event ) );
+    }
+
+    /// \brief The events located during the last integration (ordered by time)
+    [[nodiscard]] const std::vector<EventRecord>& triggeredEvents() const
+    {
+      return m_triggered_events;
     }
 
     /// \brief The integrator function
@@ -30,53 +123,247 @@ namespace ADAAI::Integration::Integrator
     /// \param state_end The final state of the system
     /// \param t_start The initial time
     /// \param t_end The final time
+    /// \param suggested_dt The first step size (then the stepper's suggestion is used)
     /// \return The time of the final state
-    double operator()( const double state_start[RHS_I::N], double state_end[RHS_I::N], double t_start = 0.0, double t_end = 2e3, double suggested_dt = 1e-2 ) const
+    double operator()( const double state_start[], double state_end[], double t_start = 0.0, double t_end = 2e3, double suggested_dt = 1e-2 ) const
     {
-      double current_time = t_start;
-      double current_state[RHS_I::N];
-      double next_state[RHS_I::N];
+      return integrate( state_start, state_end, t_start, t_end, suggested_dt, nullptr );
+    }
 
-      for ( int i = 0; i < RHS_I::N; ++i )
+    /// \brief Continues an integration from its checkpoint
+    /// \details The steps are bitwise the same as the ones of the integration that wrote the checkpoint
+    ///          (with the same stepper, RHS, observer and settings). The observer is called again at the time
+    ///          of the checkpoint unless the output times are set.
+    /// \param checkpoint The checkpoint (see setCheckpoints and ReadCheckpoint)
+    /// \param state_end The final state of the system
+    /// \param t_end The final time
+    /// \return The time of the final state
+    double resume( const Checkpoint& checkpoint, double state_end[], double t_end ) const
+    {
+      if ( checkpoint.state.size() != static_cast<std::size_t>( m_stepper->size() ) )
+      {
+        throw std::invalid_argument( "ODE_Integrator: The checkpoint is of another system" );
+      }
+      return integrate( checkpoint.state.data(), state_end, checkpoint.time, t_end, checkpoint.suggested_dt, &checkpoint );
+    }
+
+  private:
+    /// \param checkpoint The checkpoint to continue from (nullptr starts a new integration)
+    double integrate( const double state_start[], double state_end[], double t_start, double t_end, double suggested_dt, const Checkpoint* checkpoint ) const
+    {
+      const int n = m_stepper->size();
+
+      ArenaFrame           frame( m_stepper->arena() );
+      double               current_time = t_start;
+      StateArray<RHS_I::N> current_state( m_stepper->arena(), n );
+      StateArray<RHS_I::N> next_state( m_stepper->arena(), n );
+      StateArray<RHS_I::N> dense_state( m_stepper->arena(), n );
+
+      for ( int i = 0; i < n; ++i )
       {
         current_state[i] = state_start[i];
       }
 
-      int percent_count = 0;
+      const long rhs_calls_start  = m_stepper->rhsCalls();
+      const long rejections_start = m_stepper->rejections();
+      const long iterations_start = m_stepper->iterations();
 
-      while ( current_time < t_end )
+      const auto start = StatisticsNow();
+      auto       lap   = start;
+
+      m_stats = IntegrationStats();
+
+      ProgressInfo progress { t_start, t_end, t_start, 0.0, 0, 0, 0 };
+
+      const bool dense_observation = !m_output_times.empty();
+
+      m_triggered_events.clear();
+
+      long steps = 0; // Since the start of the integration (including the steps before the checkpoint)
+      if ( checkpoint != nullptr )
+      {
+        StepperSnapshot snapshot( checkpoint->stepper );
+        m_stepper->load( snapshot );
+        if ( !snapshot.done() )
+        {
+          throw std::invalid_argument( "ODE_Integrator: The checkpoint is of another stepper" );
+        }
+        steps = checkpoint->steps;
+      }
+      else
       {
+        m_stepper->reset();
+      }
+
+      std::vector<double> g_prev( m_events.size() );
+      std::vector<double> g_next( m_events.size() );
+      for ( std::size_t e = 0; e < m_events.size(); ++e )
+      {
+        g_prev[e] = m_events[e].g( current_time, current_state );
+      }
+
+      // The output at the time of a checkpoint has been observed before it
+      auto next_output = checkpoint != nullptr ? std::upper_bound( m_output_times.begin(), m_output_times.end(), t_start )
+                                               : std::lower_bound( m_output_times.begin(), m_output_times.end(), t_start );
+      if ( dense_observation && next_output != m_output_times.end() && *next_output == t_start )
+      {
+        ++next_output;
         if ( !( *m_observer )( current_time, current_state ) )
+        {
+          t_end = current_time;
+        }
+      }
+
+      while ( current_time < t_end )
+      {
+        if ( !dense_observation && !( *m_observer )( current_time, current_state ) )
         {
           break;
         }
+        AddLap( m_stats.observer_time, lap );
+
+        // The steps land exactly on the next stop time and on t_end
+        auto   next_stop = std::upper_bound( m_stop_times.begin(), m_stop_times.end(), current_time );
+        bool   at_stop   = next_stop != m_stop_times.end() && *next_stop < t_end;
+        double step_end  = at_stop ? *next_stop : t_end;
 
-        auto [next_time, dt] = ( *m_stepper )( current_state, next_state, current_time, suggested_dt );
+        bool   cut_step = current_time + suggested_dt * ( 1.0 + stop_tolerance ) >= step_end;
+        double step_dt  = cut_step ? step_end - current_time : suggested_dt;
 
-        if ( next_time > t_end )
+        m_stepper->setStepInterval( current_time, step_end );
+        auto [next_time, dt] = ( *m_stepper )( current_state, next_state, current_time, step_dt );
+        AddLap( m_stats.stepper_time, lap );
+
+        bool reached_step_end = cut_step && next_time >= step_end;
+        if ( !reached_step_end )
         {
-          dt        = t_end - current_time;
-          next_time = t_end;
+          suggested_dt = dt; // Adaptive steppers return the suggestion for the next step
+        }
+
+        // Locate the events of the step, only the ones before the first terminal event happen
+        double      stop_time           = next_time;
+        bool        stop                = false;
+        std::size_t first_step_event_id = m_triggered_events.size();
+        for ( std::size_t e = 0; e < m_events.size(); ++e )
+        {
+          g_next[e] = m_events[e].g( next_time, next_state );
+
+          if ( !IsEventCrossing( m_events[e].direction, g_prev[e], g_next[e] ) )
+          {
+            continue;
+          }
+
+          auto g_dense = [&]( double t )
+          {
+            m_stepper->dense_output( t, dense_state );
+            return m_events[e].g( t, dense_state );
+          };
+          double event_time = FindRootIllinois( g_dense, current_time, next_time, g_prev[e], g_next[e] );
+
+          EventRecord record { e, event_time, std::vector<double>( n ) };
+          m_stepper->dense_output( event_time, record.state.data() );
+          m_triggered_events.push_back( std::move( record ) );
+
+          if ( m_events[e].terminal && event_time <= stop_time )
+          {
+            stop_time = event_time;
+            stop      = true;
+          }
+        }
+
+        std::sort( m_triggered_events.begin() + ( long ) first_step_event_id, m_triggered_events.end(),
+                   []( const EventRecord& lhs, const EventRecord& rhs )
+                   {
+                     return lhs.time < rhs.time;
+                   } );
+        AddLap( m_stats.event_time, lap );
+
+        for ( ; dense_observation && next_output != m_output_times.end() && *next_output <= stop_time; ++next_output )
+        {
+          m_stepper->dense_output( *next_output, current_state );
+
+          if ( !( *m_observer )( *next_output, current_state ) )
+          {
+            stop_time = *next_output;
+            stop      = true;
+            break;
+          }
+        }
+
+        while ( m_triggered_events.size() > first_step_event_id && m_triggered_events.back().time > stop_time )
+        {
+          m_triggered_events.pop_back();
+        }
+        AddLap( m_stats.observer_time, lap );
+
+        if constexpr ( StatisticsEnabled )
+        {
+          m_stats.addStep( stop_time - current_time );
+        }
+
+        if ( stop )
+        {
+          current_time = stop_time;
+          m_stepper->dense_output( stop_time, current_state );
+          break;
+        }
+
+        std::swap( g_prev, g_next );
+
+        if ( m_progress != nullptr )
+        {
+          progress.time       = next_time;
+          progress.step       = next_time - current_time;
+          progress.steps      = progress.steps + 1;
+          progress.rhs_calls  = m_stepper->rhsCalls() - rhs_calls_start;
+          progress.rejections = m_stepper->rejections() - rejections_start;
+          m_progress->step( progress );
         }
 
         current_time = next_time;
-        for ( int i = 0; i < RHS_I::N; ++i )
+        for ( int i = 0; i < n; ++i )
         {
           current_state[i] = next_state[i];
         }
 
-        if ( current_time / t_end * 100.0 > percent_count + 1 )
+        if ( reached_step_end && at_stop )
+        {
+          // The RHS may be discontinuous here: the stepper starts anew on the other side
+          current_time = step_end;
+          m_stepper->reset();
+        }
+
+        ++steps;
+        if ( m_checkpoints != nullptr && steps % m_checkpoint_interval == 0 )
         {
-          percent_count++;
-          std::cout << percent_count << "%" << std::endl;
+          StepperSnapshot snapshot;
+          m_stepper->save( snapshot );
+          m_checkpoints->submit( current_time, suggested_dt, steps, current_state, n, snapshot.bytes() );
         }
       }
 
-      for ( int i = 0; i < RHS_I::N; ++i )
+      for ( int i = 0; i < n; ++i )
       {
         state_end[i] = current_state[i];
       }
 
+      if constexpr ( StatisticsEnabled )
+      {
+        m_stats.rhs_calls      = m_stepper->rhsCalls() - rhs_calls_start;
+        m_stats.rejected_steps = m_stepper->rejections() - rejections_start;
+        m_stats.iterations     = m_stepper->iterations() - iterations_start;
+        m_stats.events         = static_cast<long>( m_triggered_events.size() );
+        m_stats.total_time     = std::chrono::duration<double>( StatisticsNow() - start ).count();
+      }
+
+      if ( m_progress != nullptr )
+      {
+        progress.time       = current_time;
+        progress.rhs_calls  = m_stepper->rhsCalls() - rhs_calls_start;
+        progress.rejections = m_stepper->rejections() - rejections_start;
+        m_progress->finish( progress );
+      }
+
       return current_time;
     }
   };
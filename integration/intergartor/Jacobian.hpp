@@ -0,0 +1,131 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstring>
+
+#include "../../utils/Consts.hpp"
+#include "State.hpp"
+#include "linalg/BandMatrix.hpp"
+
+namespace ADAAI::Integration::Integrator
+{
+  /// \brief An RHS with the banded Jacobian declares its bandwidths as 'constexpr static int ML, MU'
+  template<typename RHS>
+  concept BandedRHS = requires {
+    { RHS::ML } -> std::convertible_to<int>;
+    { RHS::MU } -> std::convertible_to<int>;
+  };
+
+  /// \brief An RHS can supply its own Jacobian as 'void jacobian( double t, const double* y, Linalg::BandMatrix& J ) const'
+  template<typename RHS>
+  concept JacobianRHS = requires( const RHS& rhs, double t, const double* y, Linalg::BandMatrix& J ) {
+    rhs.jacobian( t, y, J );
+  };
+
+  /// \brief The lower bandwidth of the Jacobian of the RHS (dense if it is not declared)
+  /// \param size The number of equations (for the runtime-sized RHS)
+  template<typename RHS>
+  constexpr int LowerBandwidth( [[maybe_unused]] int size = RHS::N )
+  {
+    if constexpr ( BandedRHS<RHS> )
+    {
+      return RHS::ML;
+    }
+    else
+    {
+      return size - 1;
+    }
+  }
+
+  /// \brief The upper bandwidth of the Jacobian of the RHS (dense if it is not declared)
+  /// \param size The number of equations (for the runtime-sized RHS)
+  template<typename RHS>
+  constexpr int UpperBandwidth( [[maybe_unused]] int size = RHS::N )
+  {
+    if constexpr ( BandedRHS<RHS> )
+    {
+      return RHS::MU;
+    }
+    else
+    {
+      return size - 1;
+    }
+  }
+
+  /// \brief Computes J = df/dy at (t, y)
+  /// \details Uses RHS::jacobian if it is provided. Otherwise the forward differences are used, the columns
+  ///          that don't share rows (j, j + ml + mu + 1, ...) are perturbed together, so the banded
+  ///          Jacobian costs ml + mu + 1 RHS calls
+  /// \param f The RHS at (t, y)
+  /// \param J The Jacobian (with the bandwidths of the RHS)
+  /// \param arena The scratch memory (for the runtime-sized RHS)
+  /// \return The number of the RHS calls
+  template<typename RHS>
+  int ComputeJacobian( const RHS& rhs, double t, const double y[], const double f[], Linalg::BandMatrix& J, Arena& arena )
+  {
+    J.setZero();
+
+    if constexpr ( JacobianRHS<RHS> )
+    {
+      rhs.jacobian( t, y, J );
+      return 0;
+    }
+    else
+    {
+      const int n     = J.size();
+      const int ml    = J.lower();
+      const int mu    = J.upper();
+      const int width = ml + mu + 1;
+
+      const double sqrt_eps = std::sqrt( CONST::EPS<double> );
+
+      ArenaFrame         frame( arena );
+      StateArray<RHS::N> y1( arena, n );
+      StateArray<RHS::N> f1( arena, n );
+      StateArray<RHS::N> delta( arena, n );
+
+      std::memcpy( y1, y, n * sizeof( double ) );
+
+      for ( int group = 0; group < std::min( width, n ); ++group )
+      {
+        for ( int j = group; j < n; j += width )
+        {
+          delta[j] = sqrt_eps * std::max( std::abs( y[j] ), 1.0 );
+          y1[j]    = y[j] + delta[j];
+        }
+
+        rhs( t, y1, f1 );
+
+        for ( int j = group; j < n; j += width )
+        {
+          for ( int i = std::max( 0, j - mu ); i <= std::min( n - 1, j + ml ); ++i )
+          {
+            J( i, j ) = ( f1[i] - f[i] ) / delta[j];
+          }
+          y1[j] = y[j];
+        }
+      }
+
+      return std::min( width, n );
+    }
+  }
+
+  /// \brief Computes df/dt at (t, y) with the forward difference
+  /// \param f The RHS at (t, y)
+  /// \return The number of the RHS calls
+  template<typename RHS>
+  int ComputeTimeDerivative( const RHS& rhs, double t, const double y[], const double f[], double dfdt[] )
+  {
+    double delta = std::sqrt( CONST::EPS<double> ) * std::max( std::abs( t ), 1.0 );
+
+    rhs( t + delta, y, dfdt );
+    for ( int i = 0, n = StateSize( rhs ); i < n; ++i )
+    {
+      dfdt[i] = ( dfdt[i] - f[i] ) / delta;
+    }
+
+    return 1;
+  }
+} // namespace ADAAI::Integration::Integrator
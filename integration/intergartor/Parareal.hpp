@@ -0,0 +1,238 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "Interator.hpp"
+#include "ThreadPool.hpp"
+
+namespace ADAAI::Integration::Integrator
+{
+  /// \brief The cost of a Parareal integration
+  struct PararealStats
+  {
+    int    iterations  = 0;
+    double change      = 0.0; // The largest relative change of a slice boundary in the last iteration
+    double total_time  = 0.0; // The wall time (seconds)
+    double coarse_time = 0.0; // The serial coarse propagations and corrections
+    double fine_time   = 0.0; // The wall time of the parallel fine propagations
+    double fine_work   = 0.0; // The sum of the times of the fine propagations
+
+    std::vector<std::vector<double>> slice_times; // The times of the fine propagations per iteration
+
+    /// \brief The wall time with 'cores' workers (the coarse propagations plus the schedules of the fine ones)
+    /// \details The slices are taken by the first free worker in their order, as the integrator does
+    [[nodiscard]] double projectedTime( int cores ) const
+    {
+      double time = coarse_time;
+      for ( const auto& times : slice_times )
+      {
+        std::vector<double> workers( std::max( cores, 1 ), 0.0 );
+        for ( double slice : times )
+        {
+          *std::min_element( workers.begin(), workers.end() ) += slice;
+        }
+        time += *std::max_element( workers.begin(), workers.end() );
+      }
+      return time;
+    }
+  }; // struct PararealStats
+
+  /// \brief Parareal: the parallel-in-time integration over the slices of [t_start, t_end]
+  /// \details The cheap coarse propagator G runs serially over the slices, the accurate fine propagator F runs
+  ///          over all of the slices at once on the workers. The boundaries are corrected by
+  ///          U_{n+1} = G(U_n) + F(U_n_old) - G(U_n_old) until they stop changing. After k iterations the first k
+  ///          slices are exact (as accurate as F), so the slices before them are not propagated again.
+  ///          The fine sweeps run on a persistent thread pool. Each worker owns its fine stepper (taken by the worker
+  ///          index of the pool), the steppers carry their state between the steps.
+  ///          The speedup is at most slices / iterations, so G must be much cheaper than F but still close enough
+  ///          for a few iterations, e.g. a fixed step low order symplectic stepper for an orbit.
+  /// \tparam CoarseTS The coarse time stepper (e.g. Störmer-Verlet with a big fixed step)
+  /// \tparam FineTS The fine time stepper (e.g. Everhart)
+  template<typename RHS_I, typename CoarseTS, typename FineTS>
+    requires std::is_base_of_v<Stepper::TimeStepper<RHS_I>, CoarseTS> && std::is_base_of_v<Stepper::TimeStepper<RHS_I>, FineTS>
+  class Parareal_Integrator
+  {
+  public:
+    using FineFactory = std::function<std::unique_ptr<FineTS>()>;
+
+  private:
+    struct PassObserver : Observer<RHS_I>
+    {
+      bool operator()( [[maybe_unused]] double current_time, [[maybe_unused]] const double current_state[RHS_I::N] ) const override
+      {
+        return true;
+      }
+    };
+
+    const CoarseTS* m_coarse;
+    double          m_coarse_dt;
+    double          m_fine_dt;
+
+    std::vector<std::unique_ptr<FineTS>> m_fine; // One per worker
+
+    int    m_slices;
+    double m_tolerance;
+    int    m_max_iterations;
+
+    mutable ThreadPool    m_pool;
+    mutable PararealStats m_stats;
+
+    template<typename TS>
+    static void propagate( const TS* stepper, const double y0[RHS_I::N], double y1[RHS_I::N], double t0, double t1, double dt )
+    {
+      PassObserver observer;
+      ODE_Integrator<RHS_I, TS, PassObserver> integrator( stepper, &observer );
+      integrator( y0, y1, t0, t1, dt );
+    }
+
+    /// \brief F over the slices [first, m_slices) on the workers
+    void fine_sweep( int first, const std::vector<double>& U, std::vector<double>& F, const std::vector<double>& T, std::vector<double>& times ) const
+    {
+      m_pool.parallel_for( m_slices - first, [&]( int index, int worker )
+                           {
+                             int  n     = first + index;
+                             auto start = std::chrono::steady_clock::now();
+                             propagate( m_fine[worker].get(), &U[n * RHS_I::N], &F[n * RHS_I::N], T[n], T[n + 1], m_fine_dt );
+                             times[index] = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+                           } );
+    }
+
+  public:
+    /// \param coarse The coarse stepper
+    /// \param fine The factory of the fine steppers (one is made per worker, the RHS is called from all of them at once)
+    /// \param coarse_dt The step of the coarse stepper
+    /// \param fine_dt The first step of the fine stepper in each slice
+    /// \param slices The number of the time slices
+    /// \param workers The number of the threads (including the calling one)
+    /// \param tolerance The largest relative change of the slice boundaries |dU| / |U| (max norm) at convergence
+    /// \param max_iterations The limit of the iterations (the result is exact after 'slices' iterations)
+    Parareal_Integrator( const CoarseTS* coarse, const FineFactory& fine, double coarse_dt, double fine_dt, int slices, int workers,
+                         double tolerance = 1e-12, int max_iterations = 0 )
+        : m_coarse( coarse ), m_coarse_dt( coarse_dt ), m_fine_dt( fine_dt ), m_slices( slices ),
+          m_tolerance( tolerance ), m_max_iterations( max_iterations > 0 ? std::min( max_iterations, slices ) : slices ),
+          m_pool( std::max( workers, 1 ) )
+    {
+      if ( slices <= 0 || workers <= 0 )
+      {
+        throw std::invalid_argument( "Parareal_Integrator: The slices and the workers must be positive" );
+      }
+      for ( int worker = 0; worker < m_pool.size(); ++worker )
+      {
+        m_fine.push_back( fine() );
+      }
+    }
+
+    /// \brief The statistics of the last integration
+    [[nodiscard]] const PararealStats& statistics() const
+    {
+      return m_stats;
+    }
+
+    /// \brief The integrator function
+    /// \param state_start The initial state of the system
+    /// \param state_end The final state of the system
+    /// \param t_start The initial time
+    /// \param t_end The final time
+    /// \return The time of the final state
+    double operator()( const double state_start[RHS_I::N], double state_end[RHS_I::N], double t_start, double t_end ) const
+    {
+      const int N = RHS_I::N;
+
+      m_stats    = PararealStats();
+      auto start = std::chrono::steady_clock::now();
+      auto lap   = start;
+
+      auto add_lap = [&lap]( double& counter )
+      {
+        auto now = std::chrono::steady_clock::now();
+        counter += std::chrono::duration<double>( now - lap ).count();
+        lap = now;
+      };
+
+      std::vector<double> T( m_slices + 1 );
+      for ( int n = 0; n <= m_slices; ++n )
+      {
+        T[n] = t_start + ( t_end - t_start ) * n / m_slices;
+      }
+      T[m_slices] = t_end;
+
+      std::vector<double> U( ( m_slices + 1 ) * N ); // The slice boundaries
+      std::vector<double> G( m_slices * N );         // G(U_n), the coarse prediction of U_{n+1}
+      std::vector<double> F( m_slices * N );         // F(U_n)
+      double              U_new[RHS_I::N];
+      double              G_new[RHS_I::N];
+
+      std::copy( state_start, state_start + N, U.begin() );
+      for ( int n = 0; n < m_slices; ++n )
+      {
+        propagate( m_coarse, &U[n * N], &G[n * N], T[n], T[n + 1], m_coarse_dt );
+        std::copy( &G[n * N], &G[n * N] + N, &U[( n + 1 ) * N] );
+      }
+      add_lap( m_stats.coarse_time );
+
+      for ( int k = 0; k < m_max_iterations; ++k )
+      {
+        auto& times = m_stats.slice_times.emplace_back( m_slices - k );
+        fine_sweep( k, U, F, T, times );
+        add_lap( m_stats.fine_time );
+
+        // U_k is exact, so U_{k+1} = F(U_k)
+        double change = 0.0;
+        for ( int n = k; n < m_slices; ++n )
+        {
+          if ( n == k )
+          {
+            std::copy( &F[n * N], &F[n * N] + N, U_new );
+          }
+          else
+          {
+            propagate( m_coarse, &U[n * N], G_new, T[n], T[n + 1], m_coarse_dt );
+            for ( int i = 0; i < N; ++i )
+            {
+              U_new[i]     = G_new[i] + F[n * N + i] - G[n * N + i];
+              G[n * N + i] = G_new[i];
+            }
+          }
+
+          double difference = 0.0;
+          double norm       = 0.0;
+          for ( int i = 0; i < N; ++i )
+          {
+            difference = std::max( difference, std::abs( U_new[i] - U[( n + 1 ) * N + i] ) );
+            norm       = std::max( norm, std::abs( U_new[i] ) );
+          }
+          change = std::max( change, norm > 0.0 ? difference / norm : difference );
+
+          std::copy( U_new, U_new + N, &U[( n + 1 ) * N] );
+        }
+        add_lap( m_stats.coarse_time );
+
+        m_stats.iterations = k + 1;
+        m_stats.change     = change;
+        if ( change <= m_tolerance )
+        {
+          break;
+        }
+      }
+
+      std::copy( &U[m_slices * N], &U[m_slices * N] + N, state_end );
+
+      for ( const auto& times : m_stats.slice_times )
+      {
+        for ( double time : times )
+        {
+          m_stats.fine_work += time;
+        }
+      }
+      m_stats.total_time = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+      return t_end;
+    }
+  }; // class Parareal_Integrator
+} // namespace ADAAI::Integration::Integrator
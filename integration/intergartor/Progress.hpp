@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+
+namespace ADAAI::Integration::Integrator
+{
+  /// \brief The state of an integration reported to a progress sink
+  struct ProgressInfo
+  {
+    double t_start;
+    double t_end;
+    double time;       // The current time
+    double step;       // The size of the last step
+    long   steps;      // The accepted steps so far
+    long   rhs_calls;  // The RHS calls of the stepper so far
+    long   rejections; // The rejected step attempts of the stepper so far
+  };
+
+  /// \brief Receives the progress of the integrations (ignores it by default)
+  /// \details The integrator calls 'step' after every accepted step and 'finish' once at the end,
+  ///          so the sinks must be cheap and thread safe if they are shared by the parallel integrations
+  class ProgressSink
+  {
+  public:
+    virtual ~ProgressSink() = default;
+
+    virtual void step( [[maybe_unused]] const ProgressInfo& info ) const
+    {
+    }
+
+    virtual void finish( [[maybe_unused]] const ProgressInfo& info ) const
+    {
+    }
+  }; // class ProgressSink
+
+  /// \brief Sums the counters of all the integrations it is attached to (lock-free)
+  class CountingProgressSink : public ProgressSink
+  {
+    mutable std::atomic<long> m_integrations { 0 };
+    mutable std::atomic<long> m_steps { 0 };
+    mutable std::atomic<long> m_rhs_calls { 0 };
+    mutable std::atomic<long> m_rejections { 0 };
+
+  public:
+    void finish( const ProgressInfo& info ) const override
+    {
+      m_integrations.fetch_add( 1, std::memory_order_relaxed );
+      m_steps.fetch_add( info.steps, std::memory_order_relaxed );
+      m_rhs_calls.fetch_add( info.rhs_calls, std::memory_order_relaxed );
+      m_rejections.fetch_add( info.rejections, std::memory_order_relaxed );
+    }
+
+    [[nodiscard]] long integrations() const
+    {
+      return m_integrations.load( std::memory_order_relaxed );
+    }
+
+    [[nodiscard]] long steps() const
+    {
+      return m_steps.load( std::memory_order_relaxed );
+    }
+
+    [[nodiscard]] long rhsCalls() const
+    {
+      return m_rhs_calls.load( std::memory_order_relaxed );
+    }
+
+    [[nodiscard]] long rejections() const
+    {
+      return m_rejections.load( std::memory_order_relaxed );
+    }
+  }; // class CountingProgressSink
+
+  /// \brief Prints the percentage of the integration with the counters, at most once per 'interval'
+  /// \details A step is checked against the clock only when the percentage moves, so the sink costs
+  ///          a comparison per step. The lines of the concurrent integrations don't interleave.
+  class ConsoleProgressSink : public ProgressSink
+  {
+    std::ostream*             m_stream;
+    std::chrono::milliseconds m_interval;
+
+    mutable std::mutex                            m_mutex;
+    mutable std::chrono::steady_clock::time_point m_last_report {};
+
+    void report( const ProgressInfo& info, double percent ) const
+    {
+      std::lock_guard lock( m_mutex );
+
+      *m_stream << static_cast<int>( percent ) << "% t = " << info.time << " dt = " << info.step << " steps = " << info.steps
+                << " rhs calls = " << info.rhs_calls << " rejections = " << info.rejections << '\n';
+    }
+
+  public:
+    /// \param stream The stream of the reports
+    /// \param interval The minimal time between the reports
+    explicit ConsoleProgressSink( std::ostream& stream = std::cout, std::chrono::milliseconds interval = std::chrono::milliseconds( 500 ) )
+        : m_stream( &stream ), m_interval( interval )
+    {
+    }
+
+    void step( const ProgressInfo& info ) const override
+    {
+      double percent = ( info.time - info.t_start ) / ( info.t_end - info.t_start ) * 100.0;
+      double before  = ( info.time - info.step - info.t_start ) / ( info.t_end - info.t_start ) * 100.0;
+      if ( static_cast<int>( percent ) == static_cast<int>( before ) )
+      {
+        return;
+      }
+
+      auto now = std::chrono::steady_clock::now();
+      {
+        std::lock_guard lock( m_mutex );
+        if ( now - m_last_report < m_interval )
+        {
+          return;
+        }
+        m_last_report = now;
+      }
+
+      report( info, percent );
+    }
+
+    void finish( const ProgressInfo& info ) const override
+    {
+      report( info, 100.0 * ( info.time - info.t_start ) / ( info.t_end - info.t_start ) );
+    }
+  }; // class ConsoleProgressSink
+} // namespace ADAAI::Integration::Integrator
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <algorithm>
+#include <limits>
+
 namespace ADAAI::Integration::Integrator
 {
   struct RHS
@@ -24,10 +27,51 @@ namespace ADAAI::Integration::Integrator
     }
 
     /// \brief The right-hand side of the harmonic oscillator equation
-    void operator()( [[maybe_unused]] double current_time, const double* current_state, double* rhs ) const override
+    void operator()( double current_time, const double* current_state, double* rhs ) const override
+    {
+      evaluate( current_time, current_state, rhs );
+    }
+
+    /// \brief The right-hand side for double or an AD type (e.g. the Taylor series of the state)
+    template<typename T>
+    void evaluate( [[maybe_unused]] const T& current_time, const T* current_state, T* rhs ) const
     {
       rhs[0] = current_state[1];
       rhs[1] = -m_omega2 * current_state[0];
     }
   }; // struct HarmonicOsc_RHS
+
+  /// \brief An RHS that is discontinuous in time declares the (sorted) times of the discontinuities
+  ///        as 'constexpr static std::array<double, M> breakpoints'
+  template<typename RHS_I>
+  concept BreakpointRHS = requires {
+    RHS_I::breakpoints.begin();
+    RHS_I::breakpoints.end();
+  };
+
+  /// \brief The first breakpoint of the RHS after t (infinity if there is none)
+  template<typename RHS_I>
+  constexpr double NextBreakpoint( double t )
+  {
+    if constexpr ( BreakpointRHS<RHS_I> )
+    {
+      auto next = std::upper_bound( RHS_I::breakpoints.begin(), RHS_I::breakpoints.end(), t );
+      if ( next != RHS_I::breakpoints.end() )
+      {
+        return *next;
+      }
+    }
+    return std::numeric_limits<double>::infinity();
+  }
+
+  /// \brief If t is a breakpoint of the RHS
+  template<typename RHS_I>
+  constexpr bool IsBreakpoint( double t )
+  {
+    if constexpr ( BreakpointRHS<RHS_I> )
+    {
+      return std::binary_search( RHS_I::breakpoints.begin(), RHS_I::breakpoints.end(), t );
+    }
+    return false;
+  }
 } // namespace ADAAI::Integration::Integrator
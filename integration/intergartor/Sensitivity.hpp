@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#include "../../utils/Consts.hpp"
+#include "Jacobian.hpp"
+#include "RHS.hpp"
+
+namespace ADAAI::Integration::Integrator
+{
+  /// \brief The system together with its variational equations (forward sensitivities)
+  /// \details The state is y followed by the columns s_k = dy/dp_k of P parameters of the initial state,
+  ///          s_k' = J s_k. If RHS_I supplies its Jacobian (see JacobianRHS), J s_k is exact. Otherwise it is the
+  ///          directional difference (f(y + delta s_k) - f(y)) / delta (P + 1 RHS calls per evaluation), whose relative
+  ///          error is about sqrt(eps): the sensitivities are then accurate to about 1e-8 whatever the tolerance of the stepper.
+  ///          The Jacobian is kept between the evaluations, so the RHS is evaluated by one thread at a time.
+  /// \tparam RHS_I The right-hand side of the system
+  /// \tparam P The number of the parameters
+  template<typename RHS_I, int P>
+  struct SensitivityRHS : RHS
+  {
+    constexpr static int N = RHS_I::N * ( 1 + P ); // y, dy/dp_1, ..., dy/dp_P
+
+    const RHS_I* m_rhs;
+
+    mutable Linalg::BandMatrix m_jacobian; // J of the last evaluation (unused without JacobianRHS)
+
+    explicit SensitivityRHS( const RHS_I* rhs )
+        : m_rhs( rhs ), m_jacobian( JacobianMatrix() )
+    {
+    }
+
+  private:
+    static Linalg::BandMatrix JacobianMatrix()
+    {
+      if constexpr ( JacobianRHS<RHS_I> )
+      {
+        return { RHS_I::N, LowerBandwidth<RHS_I>(), UpperBandwidth<RHS_I>() };
+      }
+      else
+      {
+        return { 1, 0, 0 };
+      }
+    }
+
+  public:
+
+    void operator()( double current_time, const double* current_state, double* rhs ) const override
+    {
+      constexpr int n = RHS_I::N;
+
+      const double* y = current_state;
+      ( *m_rhs )( current_time, y, rhs );
+
+      if constexpr ( JacobianRHS<RHS_I> )
+      {
+        m_jacobian.setZero();
+        m_rhs->jacobian( current_time, y, m_jacobian );
+
+        for ( int k = 0; k < P; ++k )
+        {
+          m_jacobian.multiply( current_state + n * ( k + 1 ), rhs + n * ( k + 1 ) );
+        }
+      }
+      else
+      {
+        double y_norm = 0.0;
+        for ( int i = 0; i < n; ++i )
+        {
+          y_norm = std::max( y_norm, std::abs( y[i] ) );
+        }
+
+        double y1[n];
+        for ( int k = 0; k < P; ++k )
+        {
+          const double* s  = current_state + n * ( k + 1 );
+          double*       ds = rhs + n * ( k + 1 );
+
+          double s_norm = 0.0;
+          for ( int i = 0; i < n; ++i )
+          {
+            s_norm = std::max( s_norm, std::abs( s[i] ) );
+          }
+          if ( s_norm == 0.0 )
+          {
+            std::fill( ds, ds + n, 0.0 );
+            continue;
+          }
+
+          double delta = std::sqrt( CONST::EPS<double> ) * std::max( y_norm, 1.0 ) / s_norm;
+          for ( int i = 0; i < n; ++i )
+          {
+            y1[i] = y[i] + delta * s[i];
+          }
+
+          ( *m_rhs )( current_time, y1, ds );
+          for ( int i = 0; i < n; ++i )
+          {
+            ds[i] = ( ds[i] - rhs[i] ) / delta;
+          }
+        }
+      }
+    }
+  }; // struct SensitivityRHS
+} // namespace ADAAI::Integration::Integrator
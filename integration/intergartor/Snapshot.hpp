@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ADAAI::Integration::Integrator
+{
+  /// \brief The bytes of the data a stepper carries across the steps (see TimeStepper::save)
+  /// \details The values are appended by 'put' and read back in the same order by 'get'.
+  ///          The bytes are in the native layout: a snapshot is read by the same build of the same stepper.
+  class StepperSnapshot
+  {
+    std::vector<char> m_bytes;
+    std::size_t       m_offset = 0; // The next byte to read
+
+  public:
+    StepperSnapshot() = default;
+
+    explicit StepperSnapshot( std::vector<char> bytes )
+        : m_bytes( std::move( bytes ) )
+    {
+    }
+
+    [[nodiscard]] const std::vector<char>& bytes() const
+    {
+      return m_bytes;
+    }
+
+    /// \brief If all of the bytes have been read
+    [[nodiscard]] bool done() const
+    {
+      return m_offset == m_bytes.size();
+    }
+
+    template<typename T>
+      requires std::is_trivially_copyable_v<T>
+    void put( const T& value )
+    {
+      put( &value, 1 );
+    }
+
+    template<typename T>
+      requires std::is_trivially_copyable_v<T>
+    void put( const T* values, std::size_t count )
+    {
+      const auto* begin = reinterpret_cast<const char*>( values );
+      m_bytes.insert( m_bytes.end(), begin, begin + count * sizeof( T ) );
+    }
+
+    template<typename T>
+      requires std::is_trivially_copyable_v<T>
+    void get( T& value )
+    {
+      get( &value, 1 );
+    }
+
+    template<typename T>
+      requires std::is_trivially_copyable_v<T>
+    void get( T* values, std::size_t count )
+    {
+      if ( m_bytes.size() - m_offset < count * sizeof( T ) )
+      {
+        throw std::runtime_error( "StepperSnapshot: The snapshot is of another stepper" );
+      }
+      std::memcpy( values, m_bytes.data() + m_offset, count * sizeof( T ) );
+      m_offset += count * sizeof( T );
+    }
+  }; // class StepperSnapshot
+} // namespace ADAAI::Integration::Integrator
@@ -0,0 +1,271 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace ADAAI::Integration::Integrator
+{
+  /// \brief The number of equations of an RHS whose size is known at runtime only ('int size() const')
+  constexpr int Dynamic = -1;
+
+  /// \brief The number of equations of the RHS
+  template<typename RHS_I>
+  int StateSize( [[maybe_unused]] const RHS_I& rhs )
+  {
+    if constexpr ( RHS_I::N == Dynamic )
+    {
+      return rhs.size();
+    }
+    else
+    {
+      return RHS_I::N;
+    }
+  }
+
+  /// \brief A bump allocator of doubles for the scratch data of the steps
+  /// \details The memory is taken in LIFO order by the frames (see ArenaFrame) and it is kept between them,
+  ///          so once the arena has grown to the largest step the steps don't allocate. The blocks are never
+  ///          moved while they are in use: a frame that doesn't fit goes on to the next block, and the blocks are
+  ///          merged into one when the outermost frame ends. An arena may be shared by the steppers and the solves of one thread.
+  class Arena
+  {
+    std::vector<std::unique_ptr<double[]>> m_blocks;
+    std::vector<std::size_t>               m_sizes;
+    std::size_t                            m_block       = 0; // The block in use
+    std::size_t                            m_used        = 0; // In the block in use
+    std::size_t                            m_peak        = 0; // The most doubles spanned at once
+    int                                    m_frames      = 0;
+    long                                   m_allocations = 0;
+
+    void make_block( std::size_t block, std::size_t size )
+    {
+      if ( block == m_blocks.size() )
+      {
+        m_blocks.emplace_back();
+        m_sizes.push_back( 0 );
+      }
+      m_blocks[block].reset( new double[size] );
+      m_sizes[block] = size;
+      m_allocations++;
+    }
+
+  public:
+    struct Mark
+    {
+      std::size_t block;
+      std::size_t used;
+    };
+
+    /// \param capacity The doubles allocated up front
+    explicit Arena( std::size_t capacity = 0 )
+    {
+      if ( capacity > 0 )
+      {
+        make_block( 0, capacity );
+      }
+    }
+
+    Arena( const Arena& )            = delete;
+    Arena& operator=( const Arena& ) = delete;
+
+    /// \brief Takes 'size' doubles (uninitialized) until the frame ends
+    double* allocate( std::size_t size )
+    {
+      if ( m_frames == 0 )
+      {
+        throw std::logic_error( "Arena: The memory is taken outside of a frame" );
+      }
+      if ( m_blocks.empty() )
+      {
+        make_block( 0, size );
+      }
+      else if ( m_used + size > m_sizes[m_block] )
+      {
+        // The blocks after the one in use are free
+        m_block++;
+        m_used = 0;
+        if ( m_block == m_blocks.size() || m_sizes[m_block] < size )
+        {
+          make_block( m_block, std::max( size, capacity() ) );
+        }
+      }
+
+      double* data = m_blocks[m_block].get() + m_used;
+      m_used += size;
+
+      std::size_t spanned = m_used;
+      for ( std::size_t block = 0; block < m_block; ++block )
+      {
+        spanned += m_sizes[block];
+      }
+      m_peak = std::max( m_peak, spanned );
+
+      return data;
+    }
+
+    [[nodiscard]] Mark mark() const
+    {
+      return { m_block, m_used };
+    }
+
+    void begin_frame()
+    {
+      m_frames++;
+    }
+
+    /// \brief Returns the memory taken after the mark
+    void end_frame( Mark mark )
+    {
+      m_block = mark.block;
+      m_used  = mark.used;
+
+      if ( --m_frames == 0 && m_blocks.size() > 1 )
+      {
+        m_blocks.clear();
+        m_sizes.clear();
+        make_block( 0, m_peak );
+        m_block = 0;
+        m_used  = 0;
+      }
+    }
+
+    /// \brief The doubles in the blocks
+    [[nodiscard]] std::size_t capacity() const
+    {
+      std::size_t capacity = 0;
+      for ( std::size_t size : m_sizes )
+      {
+        capacity += size;
+      }
+      return capacity;
+    }
+
+    /// \brief The blocks allocated so far (it stops growing once the arena fits the steps)
+    [[nodiscard]] long allocations() const
+    {
+      return m_allocations;
+    }
+  }; // class Arena
+
+  /// \brief The scope of the memory taken from an arena
+  class ArenaFrame
+  {
+    Arena&      m_arena;
+    Arena::Mark m_mark;
+
+  public:
+    explicit ArenaFrame( Arena& arena )
+        : m_arena( arena ), m_mark( arena.mark() )
+    {
+      m_arena.begin_frame();
+    }
+
+    ArenaFrame( const ArenaFrame& )            = delete;
+    ArenaFrame& operator=( const ArenaFrame& ) = delete;
+
+    ~ArenaFrame()
+    {
+      m_arena.end_frame( m_mark );
+    }
+  }; // class ArenaFrame
+
+  /// \brief The scratch array of 'Count' states: on the stack for the compile-time size, from the arena otherwise
+  /// \details The arena is not touched for the compile-time size, the runtime size needs an ArenaFrame.
+  ///          The states follow each other (the k-th one starts at k * size).
+  template<int N, int Count = 1>
+  class StateArray
+  {
+    double m_data[N * Count];
+
+  public:
+    StateArray( [[maybe_unused]] Arena& arena, [[maybe_unused]] int size )
+    {
+    }
+
+    StateArray( const StateArray& )            = delete;
+    StateArray& operator=( const StateArray& ) = delete;
+
+    operator double*()
+    {
+      return m_data;
+    }
+
+    double* data()
+    {
+      return m_data;
+    }
+  }; // class StateArray
+
+  template<int Count>
+  class StateArray<Dynamic, Count>
+  {
+    double* m_data;
+
+  public:
+    StateArray( Arena& arena, int size )
+        : m_data( arena.allocate( static_cast<std::size_t>( size ) * Count ) )
+    {
+    }
+
+    StateArray( const StateArray& )            = delete;
+    StateArray& operator=( const StateArray& ) = delete;
+
+    operator double*()
+    {
+      return m_data;
+    }
+
+    double* data()
+    {
+      return m_data;
+    }
+  }; // class StateArray<Dynamic>
+
+  /// \brief The state-sized data kept between the steps: a member array for the compile-time size,
+  ///        allocated once by the constructor otherwise
+  template<int N>
+  class StateStorage
+  {
+    double m_data[N] {};
+
+  public:
+    explicit StateStorage( [[maybe_unused]] int size )
+    {
+    }
+
+    operator double*()
+    {
+      return m_data;
+    }
+
+    operator const double*() const
+    {
+      return m_data;
+    }
+  }; // class StateStorage
+
+  template<>
+  class StateStorage<Dynamic>
+  {
+    std::vector<double> m_data;
+
+  public:
+    explicit StateStorage( int size )
+        : m_data( size )
+    {
+    }
+
+    operator double*()
+    {
+      return m_data.data();
+    }
+
+    operator const double*() const
+    {
+      return m_data.data();
+    }
+  }; // class StateStorage<Dynamic>
+} // namespace ADAAI::Integration::Integrator
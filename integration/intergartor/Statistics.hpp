@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+namespace ADAAI::Integration::Integrator
+{
+  /// \brief The statistics are collected unless INTEGRATION_NO_STATS is defined before the includes
+#ifdef INTEGRATION_NO_STATS
+  constexpr bool StatisticsEnabled = false;
+#else
+  constexpr bool StatisticsEnabled = true;
+#endif
+
+  using StatisticsClock = std::chrono::steady_clock;
+
+  /// \brief The current time (a constant if the statistics are compiled out)
+  inline StatisticsClock::time_point StatisticsNow()
+  {
+    if constexpr ( StatisticsEnabled )
+    {
+      return StatisticsClock::now();
+    }
+    else
+    {
+      return {};
+    }
+  }
+
+  /// \brief Adds the time since 'lap' to 'counter' (seconds) and restarts the lap
+  inline void AddLap( double& counter, StatisticsClock::time_point& lap )
+  {
+    if constexpr ( StatisticsEnabled )
+    {
+      auto now = StatisticsClock::now();
+      counter += std::chrono::duration<double>( now - lap ).count();
+      lap = now;
+    }
+  }
+
+  /// \brief The cost of an integration
+  struct IntegrationStats
+  {
+    constexpr static int min_step_exponent = -40; // The bin k counts the steps 2^(k + min) <= h < 2^(k + min + 1)
+    constexpr static int histogram_size    = 60;  // The first and the last bins take all of the smaller and larger steps
+
+    long rhs_calls      = 0;
+    long accepted_steps = 0;
+    long rejected_steps = 0;
+    long iterations     = 0; // The Newton / corrector iterations of the stepper
+    long events         = 0; // The located events
+
+    double min_step = std::numeric_limits<double>::infinity();
+    double max_step = 0.0;
+
+    std::array<long, histogram_size> step_histogram {};
+
+    // The wall time (seconds)
+    double total_time    = 0.0;
+    double stepper_time  = 0.0; // The steps
+    double event_time    = 0.0; // The event functions and the location of the events
+    double observer_time = 0.0; // The observer and the dense output for it
+
+    void addStep( double h )
+    {
+      accepted_steps++;
+      min_step = std::min( min_step, h );
+      max_step = std::max( max_step, h );
+
+      int exponent = 0;
+      std::frexp( h, &exponent ); // h = m * 2^exponent, 0.5 <= m < 1
+      step_histogram[std::clamp( exponent - 1 - min_step_exponent, 0, histogram_size - 1 )]++;
+    }
+
+    /// \brief Writes the statistics as a JSON object (the histogram lists the non-empty bins by their lower bound)
+    void writeJSON( std::ostream& stream ) const
+    {
+      stream << "{\"rhs_calls\": " << rhs_calls
+             << ", \"accepted_steps\": " << accepted_steps
+             << ", \"rejected_steps\": " << rejected_steps
+             << ", \"iterations\": " << iterations
+             << ", \"events\": " << events
+             << ", \"min_step\": " << ( accepted_steps > 0 ? min_step : 0.0 )
+             << ", \"max_step\": " << max_step
+             << ", \"step_histogram\": {";
+
+      bool first = true;
+      for ( int k = 0; k < histogram_size; ++k )
+      {
+        if ( step_histogram[k] == 0 )
+        {
+          continue;
+        }
+        stream << ( first ? "" : ", " ) << "\"" << std::ldexp( 1.0, k + min_step_exponent ) << "\": " << step_histogram[k];
+        first = false;
+      }
+
+      stream << "}, \"time\": {\"total\": " << total_time
+             << ", \"stepper\": " << stepper_time
+             << ", \"events\": " << event_time
+             << ", \"observer\": " << observer_time << "}}";
+    }
+
+    [[nodiscard]] std::string toJSON() const
+    {
+      std::ostringstream stream;
+      writeJSON( stream );
+      return stream.str();
+    }
+  }; // struct IntegrationStats
+} // namespace ADAAI::Integration::Integrator
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ADAAI::Integration::Integrator
+{
+  /// \brief A fixed set of worker threads running the parallel loops
+  /// \details The workers are started once and sleep on a condition variable between the loops, so a loop costs
+  ///          a wake-up instead of the thread creations. The calling thread works on the loop too (it is worker 0).
+  ///          The loops of one pool run one at a time (the pool belongs to one integrator or stepper).
+  class ThreadPool
+  {
+  public:
+    using Task = std::function<void( int index, int worker )>;
+
+  private:
+    std::vector<std::thread> m_threads;
+
+    std::mutex              m_mutex;
+    std::condition_variable m_wake; // A new loop or the stop for the workers
+    std::condition_variable m_done; // The last worker has left the loop
+
+    const Task*        m_task  = nullptr;
+    int                m_count = 0;
+    std::atomic<int>   m_next { 0 };
+    int                m_busy       = 0; // The workers still in the loop
+    long               m_generation = 0; // The number of the loops started (the workers wait for a new one)
+    bool               m_stop       = false;
+    std::exception_ptr m_exception;
+
+    /// \brief Takes the indices of the loop until there are none (the first exception ends the loop)
+    void run_tasks( int worker )
+    {
+      for ( int index = m_next++; index < m_count; index = m_next++ )
+      {
+        try
+        {
+          ( *m_task )( index, worker );
+        }
+        catch ( ... )
+        {
+          std::lock_guard lock( m_mutex );
+          if ( !m_exception )
+          {
+            m_exception = std::current_exception();
+          }
+          m_next = m_count;
+        }
+      }
+    }
+
+    void work( int worker )
+    {
+      long seen = 0;
+      while ( true )
+      {
+        {
+          std::unique_lock lock( m_mutex );
+          m_wake.wait( lock, [&]
+                       { return m_stop || m_generation != seen; } );
+          if ( m_stop )
+          {
+            return;
+          }
+          seen = m_generation;
+        }
+
+        run_tasks( worker );
+
+        std::lock_guard lock( m_mutex );
+        if ( --m_busy == 0 )
+        {
+          m_done.notify_one();
+        }
+      }
+    }
+
+  public:
+    /// \param threads The number of the threads including the calling one (1: the loops run serially)
+    explicit ThreadPool( int threads )
+    {
+      for ( int worker = 1; worker < threads; ++worker )
+      {
+        m_threads.emplace_back( &ThreadPool::work, this, worker );
+      }
+    }
+
+    ThreadPool( const ThreadPool& )            = delete;
+    ThreadPool& operator=( const ThreadPool& ) = delete;
+
+    ~ThreadPool()
+    {
+      {
+        std::lock_guard lock( m_mutex );
+        m_stop = true;
+      }
+      m_wake.notify_all();
+      for ( auto& thread : m_threads )
+      {
+        thread.join();
+      }
+    }
+
+    /// \brief The number of the threads including the calling one
+    [[nodiscard]] int size() const
+    {
+      return static_cast<int>( m_threads.size() ) + 1;
+    }
+
+    /// \brief Calls task( index, worker ) for the indices [0, count) on the workers and waits for all of them
+    /// \details The indices are taken in their order by the first free worker. The first exception of the tasks
+    ///          stops the loop and is rethrown.
+    void parallel_for( int count, const Task& task )
+    {
+      if ( m_threads.empty() || count <= 1 )
+      {
+        for ( int index = 0; index < count; ++index )
+        {
+          task( index, 0 );
+        }
+        return;
+      }
+
+      {
+        std::lock_guard lock( m_mutex );
+        m_task      = &task;
+        m_count     = count;
+        m_next      = 0;
+        m_busy      = static_cast<int>( m_threads.size() );
+        m_exception = nullptr;
+        ++m_generation;
+      }
+      m_wake.notify_all();
+
+      run_tasks( 0 );
+
+      std::unique_lock lock( m_mutex );
+      m_done.wait( lock, [this]
+                   { return m_busy == 0; } );
+      m_task = nullptr;
+      if ( m_exception )
+      {
+        std::rethrow_exception( std::exchange( m_exception, nullptr ) );
+      }
+    }
+  }; // class ThreadPool
+} // namespace ADAAI::Integration::Integrator
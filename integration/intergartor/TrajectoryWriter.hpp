@@ -0,0 +1,224 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Observer.hpp"
+
+namespace ADAAI::Integration::Integrator
+{
+  /// \brief Writes a trajectory in the binary columnar format
+  /// \details The file is a header of 64 bytes followed by the blocks of 'block_rows' rows. A block stores its
+  ///          columns one after another: time, the N state components and (optionally) the N RHS components,
+  ///          'block_rows' float64 values each, the last block is padded with NaN. All of the numbers are
+  ///          little-endian, so the data is np.memmap( path, '<f8', offset = 64, shape = (blocks, columns, block_rows) ).
+  ///          The header:
+  ///          char magic[8] = "ADAAITRJ", uint32 version, uint32 columns, uint32 state_size, uint32 has_rhs,
+  ///          uint64 block_rows, uint64 rows (the number of the written rows), 24 reserved bytes.
+  ///          A block is written with a single call, the rows are only copied into the buffer.
+  ///          A failed write (e.g. the disk is full) throws.
+  template<typename RHS_I>
+  class TrajectoryWriter
+  {
+    // The numbers are written as they are in memory
+    static_assert( std::endian::native == std::endian::little, "TrajectoryWriter: The format is little-endian" );
+
+  public:
+    constexpr static std::size_t   header_size = 64;
+    constexpr static std::uint32_t version     = 1;
+
+  private:
+    std::string   m_path;
+    std::ofstream m_file;
+
+    bool          m_with_rhs;
+    std::uint32_t m_columns;
+    std::uint64_t m_block_rows;
+    std::uint64_t m_rows = 0;
+
+    std::vector<double> m_block; // Column-major: m_block[column * m_block_rows + row]
+    std::uint64_t       m_block_row = 0;
+
+    void write_header()
+    {
+      char header[header_size] {};
+
+      std::uint32_t state_size = RHS_I::N;
+      std::uint32_t has_rhs    = m_with_rhs ? 1 : 0;
+
+      std::memcpy( header, "ADAAITRJ", 8 );
+      std::memcpy( header + 8, &version, 4 );
+      std::memcpy( header + 12, &m_columns, 4 );
+      std::memcpy( header + 16, &state_size, 4 );
+      std::memcpy( header + 20, &has_rhs, 4 );
+      std::memcpy( header + 24, &m_block_rows, 8 );
+      std::memcpy( header + 32, &m_rows, 8 );
+
+      m_file.seekp( 0 );
+      m_file.write( header, header_size );
+      check( "the header" );
+    }
+
+    /// \brief Throws if a write has failed
+    void check( const std::string& what ) const
+    {
+      if ( !m_file.good() )
+      {
+        throw std::runtime_error( "TrajectoryWriter: Failed to write " + what + " of " + m_path );
+      }
+    }
+
+    void clear_block()
+    {
+      std::fill( m_block.begin(), m_block.end(), std::numeric_limits<double>::quiet_NaN() );
+      m_block_row = 0;
+    }
+
+    void flush_block()
+    {
+      m_file.write( reinterpret_cast<const char*>( m_block.data() ), static_cast<std::streamsize>( m_block.size() * sizeof( double ) ) );
+      check( "a block" );
+      clear_block();
+    }
+
+  public:
+    /// \param path The file to write (truncated)
+    /// \param with_rhs If the RHS columns are written
+    /// \param block_rows The rows per block
+    explicit TrajectoryWriter( const std::string& path, bool with_rhs = false, std::uint64_t block_rows = 1024 )
+        : m_path( path ),
+          m_file( path, std::ios::out | std::ios::binary | std::ios::trunc ),
+          m_with_rhs( with_rhs ),
+          m_columns( 1 + RHS_I::N * ( with_rhs ? 2 : 1 ) ),
+          m_block_rows( block_rows ),
+          m_block( m_columns * block_rows )
+    {
+      if ( !m_file )
+      {
+        throw std::runtime_error( "TrajectoryWriter: Failed to open " + path );
+      }
+      if ( block_rows == 0 )
+      {
+        throw std::invalid_argument( "TrajectoryWriter: The block must have rows" );
+      }
+
+      write_header();
+      clear_block();
+    }
+
+    TrajectoryWriter( const TrajectoryWriter& )            = delete;
+    TrajectoryWriter& operator=( const TrajectoryWriter& ) = delete;
+
+    /// \brief Closes the file (a failure is not reported here, close() reports it)
+    ~TrajectoryWriter()
+    {
+      try
+      {
+        close();
+      }
+      catch ( const std::runtime_error& )
+      {
+      }
+    }
+
+    [[nodiscard]] bool withRHS() const
+    {
+      return m_with_rhs;
+    }
+
+    [[nodiscard]] std::uint64_t rows() const
+    {
+      return m_rows;
+    }
+
+    /// \brief Appends a row
+    /// \param rhs The RHS at the state (ignored if the RHS is not written)
+    void append( double time, const double state[RHS_I::N], const double rhs[RHS_I::N] = nullptr )
+    {
+      m_block[m_block_row] = time;
+      for ( int i = 0; i < RHS_I::N; ++i )
+      {
+        m_block[( 1 + i ) * m_block_rows + m_block_row] = state[i];
+      }
+      if ( m_with_rhs && rhs != nullptr )
+      {
+        for ( int i = 0; i < RHS_I::N; ++i )
+        {
+          m_block[( 1 + RHS_I::N + i ) * m_block_rows + m_block_row] = rhs[i];
+        }
+      }
+
+      ++m_rows;
+      if ( ++m_block_row == m_block_rows )
+      {
+        flush_block();
+      }
+    }
+
+    /// \brief Writes the last block and the number of the rows
+    void close()
+    {
+      if ( !m_file.is_open() )
+      {
+        return;
+      }
+
+      if ( m_block_row > 0 )
+      {
+        flush_block();
+      }
+      write_header();
+      m_file.flush();
+      check( "the file" );
+      m_file.close();
+    }
+  }; // class TrajectoryWriter
+
+  /// \brief Writes every 'stride'-th observed state to a trajectory file
+  /// \details The RHS is evaluated only for the written rows (if the writer has the RHS columns)
+  /// \tparam RHS_O The observer deciding if the integration goes on
+  template<typename RHS_I, typename RHS_O>
+    requires std::is_base_of_v<Observer<RHS_I>, RHS_O>
+  struct TrajectoryObserver : Observer<RHS_I>
+  {
+    TrajectoryWriter<RHS_I>& m_writer;
+    const RHS_I*             m_rhs;
+    RHS_O                    m_observer;
+    int                      m_stride;
+
+    mutable int m_index = 0;
+
+    TrajectoryObserver( TrajectoryWriter<RHS_I>& writer, const RHS_I* rhs, RHS_O observer = RHS_O(), int stride = 10 )
+        : m_writer( writer ), m_rhs( rhs ), m_observer( std::move( observer ) ), m_stride( stride )
+    {
+    }
+
+    bool operator()( double current_time, const double current_state[RHS_I::N] ) const override
+    {
+      if ( ( m_index++ ) % m_stride == 0 )
+      {
+        if ( m_writer.withRHS() )
+        {
+          double rhs[RHS_I::N];
+          ( *m_rhs )( current_time, current_state, rhs );
+          m_writer.append( current_time, current_state, rhs );
+        }
+        else
+        {
+          m_writer.append( current_time, current_state );
+        }
+      }
+
+      return m_observer( current_time, current_state );
+    }
+  }; // struct TrajectoryObserver
+} // namespace ADAAI::Integration::Integrator
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace ADAAI::Integration::Integrator::Linalg
+{
+  /// \brief A square band matrix with the LU decomposition (partial pivoting) in place
+  /// \details Row i keeps the columns [i - ml, i + mu + ml], the extra ml columns are the fill-in of the row interchanges.
+  ///          A dense matrix is the band matrix with ml = mu = n - 1.
+  class BandMatrix
+  {
+    int m_n;
+    int m_ml;
+    int m_mu;
+    int m_width;
+
+    std::vector<double> m_data;
+    std::vector<int>    m_pivots; // The row interchanged with row k on the k-th step of the decomposition
+
+    [[nodiscard]] std::size_t index( int i, int j ) const
+    {
+      return static_cast<std::size_t>( i ) * m_width + ( j - i + m_ml );
+    }
+
+  public:
+    /// \param n The size of the matrix
+    /// \param ml, mu The lower and the upper bandwidths (A(i, j) = 0 if i - j > ml or j - i > mu)
+    BandMatrix( int n, int ml, int mu )
+        : m_n( n ), m_ml( ml ), m_mu( mu ), m_width( 2 * ml + mu + 1 ),
+          m_data( static_cast<std::size_t>( n ) * ( 2 * ml + mu + 1 ) ), m_pivots( n )
+    {
+      if ( n <= 0 || ml < 0 || mu < 0 || ml >= n || mu >= n )
+      {
+        throw std::invalid_argument( "BandMatrix: Invalid size or bandwidths" );
+      }
+    }
+
+    [[nodiscard]] int size() const
+    {
+      return m_n;
+    }
+
+    [[nodiscard]] int lower() const
+    {
+      return m_ml;
+    }
+
+    [[nodiscard]] int upper() const
+    {
+      return m_mu;
+    }
+
+    /// \brief The element A(i, j), (i, j) must be inside the band
+    double& operator()( int i, int j )
+    {
+      return m_data[index( i, j )];
+    }
+
+    double operator()( int i, int j ) const
+    {
+      return m_data[index( i, j )];
+    }
+
+    void setZero()
+    {
+      std::fill( m_data.begin(), m_data.end(), 0.0 );
+    }
+
+    /// \brief Computes y = Ax (before 'factorize')
+    void multiply( const double* x, double* y ) const
+    {
+      for ( int i = 0; i < m_n; ++i )
+      {
+        double sum = 0.0;
+        for ( int j = std::max( 0, i - m_ml ); j <= std::min( m_n - 1, i + m_mu ); ++j )
+        {
+          sum += ( *this )( i, j ) * x[j];
+        }
+        y[i] = sum;
+      }
+    }
+
+    /// \brief Replaces the matrix with its LU decomposition (PA = LU)
+    void factorize()
+    {
+      for ( int k = 0; k < m_n; ++k )
+      {
+        int last_row    = std::min( m_n - 1, k + m_ml );
+        int last_column = std::min( m_n - 1, k + m_ml + m_mu );
+
+        int pivot = k;
+        for ( int i = k + 1; i <= last_row; ++i )
+        {
+          if ( std::abs( ( *this )( i, k ) ) > std::abs( ( *this )( pivot, k ) ) )
+          {
+            pivot = i;
+          }
+        }
+
+        if ( ( *this )( pivot, k ) == 0.0 )
+        {
+          throw std::runtime_error( "BandMatrix: The matrix is singular" );
+        }
+
+        m_pivots[k] = pivot;
+        if ( pivot != k )
+        {
+          for ( int j = k; j <= last_column; ++j )
+          {
+            std::swap( ( *this )( k, j ), ( *this )( pivot, j ) );
+          }
+        }
+
+        for ( int i = k + 1; i <= last_row; ++i )
+        {
+          double l = ( *this )( i, k ) / ( *this )( k, k );
+
+          ( *this )( i, k ) = l;
+          for ( int j = k + 1; j <= last_column; ++j )
+          {
+            ( *this )( i, j ) -= l * ( *this )( k, j );
+          }
+        }
+      }
+    }
+
+    /// \brief Solves Ax = b with the decomposed matrix ('factorize' must be called before)
+    /// \param b The right-hand side, replaced with the solution
+    void solve( double* b ) const
+    {
+      for ( int k = 0; k < m_n; ++k )
+      {
+        std::swap( b[k], b[m_pivots[k]] );
+
+        int last_row = std::min( m_n - 1, k + m_ml );
+        for ( int i = k + 1; i <= last_row; ++i )
+        {
+          b[i] -= ( *this )( i, k ) * b[k];
+        }
+      }
+
+      for ( int i = m_n - 1; i >= 0; --i )
+      {
+        int last_column = std::min( m_n - 1, i + m_ml + m_mu );
+        for ( int j = i + 1; j <= last_column; ++j )
+        {
+          b[i] -= ( *this )( i, j ) * b[j];
+        }
+        b[i] /= ( *this )( i, i );
+      }
+    }
+  }; // class BandMatrix
+} // namespace ADAAI::Integration::Integrator::Linalg
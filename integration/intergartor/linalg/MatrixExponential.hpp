@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+#include "../../../exp/methods/PadeExponential.hpp"
+#include "BandMatrix.hpp"
+
+namespace ADAAI::Integration::Integrator::Linalg
+{
+  /// \brief Computes exp(X) of a small dense matrix (scaling and squaring)
+  /// \details X is scaled by 2^(-s) to the 1-norm at most 1, where the Pade approximation of the exp module
+  ///          (P_TERMS / Q_TERMS) is accurate to the double precision, R = Q(X)^(-1) P(X) is squared s times.
+  /// \param X The n x n matrix (row-major)
+  /// \param result exp(X) (row-major), must not overlap X
+  inline void MatrixExponential( const double* X, int n, double* result )
+  {
+    using Exp::Core::Pade::P_TERMS;
+    using Exp::Core::Pade::Q_TERMS;
+
+    const std::size_t size = static_cast<std::size_t>( n ) * n;
+
+    double norm = 0.0;
+    for ( int j = 0; j < n; ++j )
+    {
+      double column = 0.0;
+      for ( int i = 0; i < n; ++i )
+      {
+        column += std::abs( X[i * n + j] );
+      }
+      norm = std::max( norm, column );
+    }
+
+    int    squarings = norm > 1.0 ? static_cast<int>( std::ceil( std::log2( norm ) ) ) : 0;
+    double scale     = std::ldexp( 1.0, -squarings );
+
+    std::vector<double> scaled( size );
+    std::vector<double> product( size );
+    for ( std::size_t k = 0; k < size; ++k )
+    {
+      scaled[k] = X[k] * scale;
+    }
+
+    // Horner's scheme: A = X * A + term * I
+    auto polynomial = [&]( const auto& terms, std::vector<double>& A )
+    {
+      std::fill( A.begin(), A.end(), 0.0 );
+      for ( const auto& term : terms )
+      {
+        for ( int i = 0; i < n; ++i )
+        {
+          for ( int j = 0; j < n; ++j )
+          {
+            double sum = 0.0;
+            for ( int k = 0; k < n; ++k )
+            {
+              sum += scaled[i * n + k] * A[k * n + j];
+            }
+            product[i * n + j] = sum;
+          }
+          product[i * n + i] += term;
+        }
+        std::swap( A, product );
+      }
+    };
+
+    std::vector<double> numerator( size );
+    std::vector<double> denominator( size );
+    polynomial( P_TERMS<double>, numerator );
+    polynomial( Q_TERMS<double>, denominator );
+
+    // R = Q^(-1) P column by column
+    BandMatrix Q( n, n - 1, n - 1 );
+    for ( int i = 0; i < n; ++i )
+    {
+      for ( int j = 0; j < n; ++j )
+      {
+        Q( i, j ) = denominator[i * n + j];
+      }
+    }
+    Q.factorize();
+
+    std::vector<double> column( n );
+    for ( int j = 0; j < n; ++j )
+    {
+      for ( int i = 0; i < n; ++i )
+      {
+        column[i] = numerator[i * n + j];
+      }
+      Q.solve( column.data() );
+      for ( int i = 0; i < n; ++i )
+      {
+        result[i * n + j] = column[i];
+      }
+    }
+
+    for ( int s = 0; s < squarings; ++s )
+    {
+      for ( int i = 0; i < n; ++i )
+      {
+        for ( int j = 0; j < n; ++j )
+        {
+          double sum = 0.0;
+          for ( int k = 0; k < n; ++k )
+          {
+            sum += result[i * n + k] * result[k * n + j];
+          }
+          product[i * n + j] = sum;
+        }
+      }
+      std::copy( product.begin(), product.end(), result );
+    }
+  }
+} // namespace ADAAI::Integration::Integrator::Linalg
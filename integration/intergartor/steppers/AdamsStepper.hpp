@@ -0,0 +1,362 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#include "BasicTimeStepper.hpp"
+
+namespace ADAAI::Integration::Integrator::Stepper
+{
+  /// \brief The variable step, variable order Adams-Bashforth-Moulton stepper (PECE)
+  /// \details Each step predicts with Adams-Bashforth of order k, evaluates f, corrects with Adams-Moulton of order k + 1
+  ///          and evaluates f again: 2 RHS calls per step. The coefficients are the integrals of the Lagrange
+  ///          polynomials through the (unequally spaced) history of f. The difference between the corrected
+  ///          and the predicted solution of the orders k - 1, k, k + 1 estimates their local errors, the next order is
+  ///          the one allowing the largest step. The integration starts with order 1 and the order rises as the
+  ///          history fills up. The history is a ring buffer, advancing a step overwrites the oldest slot.
+  ///          The step is kept unless it can be doubled or must be reduced, so the coefficients of the steps of a
+  ///          constant size are computed once. The dense output is the corrector polynomial of the last step.
+  /// \tparam MaxOrder The maximal order of the predictor
+  template<typename RHS, int MaxOrder = 12>
+  class Adams_TimeStepper : public TimeStepper<RHS>
+  {
+    static_assert( MaxOrder >= 1 && MaxOrder <= 14, "Adams_TimeStepper: The order must be in [1, 14]" );
+
+    constexpr static int capacity = MaxOrder + 1; // The corrector of order MaxOrder + 1 uses MaxOrder + 1 points
+
+    constexpr static double max_step_growth   = 2.0;
+    constexpr static double max_step_decrease = 0.2;
+
+    // Gauss-Legendre quadrature on [0, 1] (8 nodes, exact up to degree 15)
+    constexpr static int    quadrature_size                  = 8;
+    constexpr static double quadrature_nodes[quadrature_size] = {
+        0.019855071751231856, 0.10166676129318664, 0.2372337950418355, 0.4082826787521751,
+        0.5917173212478249, 0.7627662049581645, 0.8983332387068134, 0.9801449282487681 };
+    constexpr static double quadrature_weights[quadrature_size] = {
+        0.05061426814518813, 0.11119051722668724, 0.15685332293894363, 0.18134189168918100,
+        0.18134189168918100, 0.15685332293894363, 0.11119051722668724, 0.05061426814518813 };
+
+    /// \brief The last values of f, the newest is at 'head'
+    struct History
+    {
+      double steps[capacity]; // The step ending at the point (the first point of a trajectory has none)
+      double f[capacity][RHS::N];
+      int    head = -1;
+      int    size = 0;
+
+      /// \brief The index of the j-th newest point (j = 0 is the newest)
+      [[nodiscard]] int index( int j ) const
+      {
+        return ( head - j + capacity ) % capacity;
+      }
+
+      /// \brief The slot of the new newest point
+      int push()
+      {
+        head = ( head + 1 ) % capacity;
+        size = std::min( size + 1, capacity );
+        return head;
+      }
+    };
+
+    double m_atol;
+    double m_rtol;
+
+    mutable History m_history;
+    mutable int     m_order = 1;
+
+    /// \brief The weights of the last nodes of a kind and size (a pure function of the nodes, so the memo is exact)
+    struct WeightMemo
+    {
+      double nodes[capacity + 1];
+      double weights[capacity + 1];
+      bool   valid = false;
+    };
+    mutable WeightMemo m_weight_memo[2][capacity + 2]; // [predictor, corrector][the number of the points]
+
+    // The end of the last step (the history is valid only for a continuous trajectory)
+    mutable bool   m_has_last_step = false;
+    mutable double m_last_t0       = 0.0;
+    mutable double m_last_h        = 0.0;
+    mutable double m_y0[RHS::N] {};
+    mutable double m_last_state[RHS::N] {};
+    mutable double m_last_f_pred[RHS::N] {}; // The predicted f at the end of the last step (the corrector polynomial)
+    mutable int    m_last_order = 1;
+
+    /// \brief The weights w_j of the integral over [t_n, t_n + theta h] of the polynomial through the given points of f
+    /// \param nodes The relative times of the points ((t_j - t_n) / h)
+    /// \param size The number of the points
+    /// \param theta The end of the integral (1 for the full step)
+    static void integration_weights( const double* nodes, int size, double* weights, double theta = 1.0 )
+    {
+      for ( int j = 0; j < size; ++j )
+      {
+        double w = 0.0;
+        for ( int q = 0; q < quadrature_size; ++q )
+        {
+          double L = 1.0;
+          for ( int m = 0; m < size; ++m )
+          {
+            if ( m != j )
+            {
+              L *= ( theta * quadrature_nodes[q] - nodes[m] ) / ( nodes[j] - nodes[m] );
+            }
+          }
+          w += quadrature_weights[q] * L;
+        }
+        weights[j] = theta * w;
+      }
+    }
+
+    /// \brief The weights of the full step, taken from the memo if the nodes are the same as the last ones of the kind
+    void step_weights( const double* nodes, int size, bool corrector, double* weights ) const
+    {
+      WeightMemo& memo = m_weight_memo[corrector][size];
+      if ( !memo.valid || std::memcmp( memo.nodes, nodes, size * sizeof( double ) ) != 0 )
+      {
+        integration_weights( nodes, size, memo.weights );
+        std::memcpy( memo.nodes, nodes, size * sizeof( double ) );
+        memo.valid = true;
+      }
+      std::memcpy( weights, memo.weights, size * sizeof( double ) );
+    }
+
+    /// \brief The relative times of the k newest points from the 'first' newest one ((t_j - t_first) / h)
+    /// \details The times are the sums of the steps, so the nodes of the steps of a constant size are bitwise the same
+    void history_nodes( int first, int k, double h, double* nodes ) const
+    {
+      double span = 0.0;
+      for ( int j = 0; j < k; ++j )
+      {
+        nodes[j] = -span / h;
+        if ( j + 1 < k )
+        {
+          span += m_history.steps[m_history.index( first + j )];
+        }
+      }
+    }
+
+    /// \brief The Adams-Bashforth prediction of order k (k newest points of the history)
+    void predict( const double* y0, double h, int k, double* prediction ) const
+    {
+      double nodes[capacity] {};
+      double weights[capacity];
+      history_nodes( 0, k, h, nodes );
+      step_weights( nodes, k, false, weights );
+
+      for ( int i = 0; i < RHS::N; ++i )
+      {
+        double sum = 0.0;
+        for ( int j = 0; j < k; ++j )
+        {
+          sum += weights[j] * m_history.f[m_history.index( j )][i];
+        }
+        prediction[i] = y0[i] + h * sum;
+      }
+    }
+
+    /// \brief The Adams-Moulton correction of order k + 1 (f_pred at t0 + h and k newest points of the history)
+    void correct( const double* y0, double h, int k, const double* f_pred, double* correction ) const
+    {
+      double nodes[capacity + 1] {};
+      double weights[capacity + 1];
+      nodes[0] = 1.0;
+      history_nodes( 0, k, h, nodes + 1 );
+      step_weights( nodes, k + 1, true, weights );
+
+      for ( int i = 0; i < RHS::N; ++i )
+      {
+        double sum = weights[0] * f_pred[i];
+        for ( int j = 0; j < k; ++j )
+        {
+          sum += weights[j + 1] * m_history.f[m_history.index( j )][i];
+        }
+        correction[i] = y0[i] + h * sum;
+      }
+    }
+
+    /// \brief The weighted RMS norm of the difference between the corrected and the predicted solutions
+    double error_norm( const double* corrected, const double* predicted, const double* y0 ) const
+    {
+      double sum = 0.0;
+      for ( int i = 0; i < RHS::N; ++i )
+      {
+        double scale = m_atol + m_rtol * std::max( std::abs( y0[i] ), std::abs( corrected[i] ) );
+        double error = ( corrected[i] - predicted[i] ) / scale;
+        sum += error * error;
+      }
+      return std::sqrt( sum / RHS::N );
+    }
+
+  public:
+    /// \param rhs The right-hand side of the system
+    /// \param atol, rtol The absolute and relative tolerances of the local error
+    explicit Adams_TimeStepper( const RHS* rhs, double atol = 1e-10, double rtol = 1e-10 )
+        : TimeStepper<RHS>( rhs ), m_atol( atol ), m_rtol( rtol )
+    {
+    }
+
+    /// \brief The order of the next step
+    [[nodiscard]] int order() const
+    {
+      return m_order;
+    }
+
+    /// \brief Forgets the history (the next step starts with order 1)
+    void reset() const override
+    {
+      m_has_last_step = false;
+      m_history.head  = -1;
+      m_history.size  = 0;
+      m_order         = 1;
+    }
+
+    void save( StepperSnapshot& snapshot ) const override
+    {
+      snapshot.put( m_history );
+      snapshot.put( m_order );
+      snapshot.put( m_has_last_step );
+      snapshot.put( m_last_t0 );
+      snapshot.put( m_last_h );
+      snapshot.put( m_y0, RHS::N );
+      snapshot.put( m_last_state, RHS::N );
+      snapshot.put( m_last_f_pred, RHS::N );
+      snapshot.put( m_last_order );
+    }
+
+    void load( StepperSnapshot& snapshot ) const override
+    {
+      snapshot.get( m_history );
+      snapshot.get( m_order );
+      snapshot.get( m_has_last_step );
+      snapshot.get( m_last_t0 );
+      snapshot.get( m_last_h );
+      snapshot.get( m_y0, RHS::N );
+      snapshot.get( m_last_state, RHS::N );
+      snapshot.get( m_last_f_pred, RHS::N );
+      snapshot.get( m_last_order );
+    }
+
+    /// \brief The stepper function
+    /// \param current_time The current time
+    /// \param current_state The current state of the system
+    /// \param next_state The next state of the system
+    /// \return The next time (current_time + dt) and the suggested next delta time
+
+    std::pair<double, double>
+    operator()( double current_state[RHS::N], double next_state[RHS::N], double current_time, double suggested_d_time = 1e-3 ) const override
+    {
+      bool continued = m_has_last_step &&
+                       current_time == m_last_t0 + m_last_h &&
+                       std::memcmp( current_state, m_last_state, sizeof( m_last_state ) ) == 0;
+
+      if ( !continued )
+      {
+        reset();
+
+        int slot = m_history.push();
+        this->call_rhs( current_time, current_state, m_history.f[slot] );
+      }
+
+      double h = suggested_d_time;
+
+      double predicted[RHS::N];
+      double f_pred[RHS::N];
+      double lower[RHS::N];
+      double higher[RHS::N];
+
+      while ( true )
+      {
+        this->check_step( "Adams_TimeStepper", current_time, h );
+
+        const int k = m_order;
+
+        // P E C
+        ++this->m_iterations;
+        predict( current_state, h, k, predicted );
+        this->call_rhs( current_time + h, predicted, f_pred );
+        correct( current_state, h, k, f_pred, next_state );
+
+        double error = error_norm( next_state, predicted, current_state );
+        if ( !( error <= 1.0 ) ) // A NaN error is rejected too
+        {
+          ++this->m_rejections;
+          h *= std::clamp( 0.9 * std::pow( error, -1.0 / ( k + 1 ) ), max_step_decrease, 0.9 );
+          continue;
+        }
+
+        // The order of the next step: the largest step of the orders k - 1, k, k + 1
+        int    next_order  = k;
+        double best_factor = error > 0.0 ? 0.9 * std::pow( error, -1.0 / ( k + 1 ) ) : max_step_growth;
+
+        if ( k > 1 )
+        {
+          predict( current_state, h, k - 1, lower );
+
+          double lower_error  = error_norm( next_state, lower, current_state );
+          double lower_factor = lower_error > 0.0 ? 0.9 * std::pow( lower_error, -1.0 / k ) : max_step_growth;
+          if ( lower_factor > best_factor )
+          {
+            next_order  = k - 1;
+            best_factor = lower_factor;
+          }
+        }
+        if ( k < MaxOrder && m_history.size > k )
+        {
+          predict( current_state, h, k + 1, higher );
+
+          double higher_error  = error_norm( next_state, higher, current_state );
+          double higher_factor = higher_error > 0.0 ? 0.9 * std::pow( higher_error, -1.0 / ( k + 2 ) ) : max_step_growth;
+          if ( higher_factor > best_factor )
+          {
+            next_order  = k + 1;
+            best_factor = higher_factor;
+          }
+        }
+
+        // E: f at the new point goes to the history
+        int slot              = m_history.push();
+        m_history.steps[slot] = h;
+        this->call_rhs( current_time + h, next_state, m_history.f[slot] );
+
+        m_last_order    = k;
+        m_order         = next_order;
+        m_has_last_step = true;
+        m_last_t0       = current_time;
+        m_last_h        = h;
+        std::memcpy( m_y0, current_state, sizeof( m_y0 ) );
+        std::memcpy( m_last_state, next_state, sizeof( m_last_state ) );
+        std::memcpy( m_last_f_pred, f_pred, sizeof( m_last_f_pred ) );
+
+        // The step changes only if it can be doubled or must be reduced
+        double factor = best_factor >= max_step_growth ? max_step_growth : best_factor < 1.0 ? std::max( best_factor, max_step_decrease ) : 1.0;
+
+        return { current_time + h, factor * h };
+      }
+    }
+
+    /// \brief The corrector polynomial of the last step (through f_pred at its end and the k points before)
+    void dense_output( double t, double state[RHS::N] ) const override
+    {
+      const int k = m_last_order;
+
+      double nodes[capacity + 1] {};
+      double weights[capacity + 1];
+      nodes[0] = 1.0;
+      history_nodes( 1, k, m_last_h, nodes + 1 ); // The newest point is the end of the last step
+      integration_weights( nodes, k + 1, weights, ( t - m_last_t0 ) / m_last_h );
+
+      for ( int i = 0; i < RHS::N; ++i )
+      {
+        double sum = weights[0] * m_last_f_pred[i];
+        for ( int j = 0; j < k; ++j )
+        {
+          sum += weights[j + 1] * m_history.f[m_history.index( j + 1 )][i];
+        }
+        state[i] = m_y0[i] + m_last_h * sum;
+      }
+    }
+  }; // class Adams_TimeStepper
+} // namespace ADAAI::Integration::Integrator::Stepper
@@ -0,0 +1,254 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <tuple>
+#include <utility>
+
+#include "../../../utils/Consts.hpp"
+#include "BasicTimeStepper.hpp"
+#include "RFK45_TimeStepper.hpp"
+#include "RadauIIAStepper.hpp"
+
+namespace ADAAI::Integration::Integrator::Stepper
+{
+  /// \brief Switches between an explicit and an implicit stepper by the stiffness of the problem (as LSODA does)
+  /// \details The spectral radius rho of the Jacobian is estimated by the power iterations on the directional
+  ///          differences of the RHS every few steps. The explicit stepper is stability limited if h * rho is close
+  ///          to its stability boundary, then the implicit stepper takes over. It gives the steps back when its
+  ///          steps are well inside the explicit stability region.
+  /// \tparam ExplicitTS The explicit stepper (non-stiff phases)
+  /// \tparam ImplicitTS The implicit stepper (stiff phases)
+  template<typename RHS, typename ExplicitTS = RFK45_TimeStepper<RHS>, typename ImplicitTS = RadauIIA_TimeStepper<RHS>>
+  class AutoSwitch_TimeStepper : public TimeStepper<RHS>
+  {
+    ExplicitTS m_explicit;
+    ImplicitTS m_implicit;
+
+    double m_stability_boundary; // The stability interval of the explicit stepper on the negative real axis
+
+    constexpr static int    check_interval     = 10;  // The stiffness is estimated every check_interval steps
+    constexpr static int    power_iterations   = 4;
+    constexpr static double to_implicit_margin = 0.6; // h * rho >= 0.6 * boundary: the explicit steps are stability limited
+    constexpr static double to_explicit_margin = 0.3; // h * rho < 0.3 * boundary: the implicit steps are safe for the explicit stepper
+
+    mutable bool   m_stiff              = false;
+    mutable int    m_steps_since_check  = check_interval;
+    mutable int    m_switches           = 0;
+    mutable double m_spectral_radius    = 0.0;
+    mutable double m_last_step[RHS::N] {}; // y1 - y0 of the last step, the initial vector of the power iterations
+
+    /// \brief Estimates the spectral radius of df/dy at (t, y) with the power iterations
+    double estimate_spectral_radius( double t, const double y[RHS::N] ) const
+    {
+      double f[RHS::N];
+      double y1[RHS::N];
+      double f1[RHS::N];
+      double v[RHS::N];
+
+      this->call_rhs( t, y, f );
+
+      double y_norm = 0.0;
+      double v_norm = 0.0;
+      for ( int i = 0; i < RHS::N; ++i )
+      {
+        v[i] = m_last_step[i];
+        y_norm += y[i] * y[i];
+        v_norm += v[i] * v[i];
+      }
+      if ( v_norm == 0.0 )
+      {
+        for ( int i = 0; i < RHS::N; ++i )
+        {
+          v[i] = 1.0;
+        }
+        v_norm = RHS::N;
+      }
+
+      // The perturbation is small relative to y
+      double delta = std::sqrt( CONST::EPS<double> ) * std::max( std::sqrt( y_norm ), 1.0 );
+
+      double rho = 0.0;
+      for ( int iteration = 0; iteration < power_iterations; ++iteration )
+      {
+        double scale = delta / std::sqrt( v_norm );
+        for ( int i = 0; i < RHS::N; ++i )
+        {
+          v[i] *= scale;
+          y1[i] = y[i] + v[i];
+        }
+
+        this->call_rhs( t, y1, f1 );
+
+        double w_norm = 0.0;
+        for ( int i = 0; i < RHS::N; ++i )
+        {
+          v[i] = f1[i] - f[i];
+          w_norm += v[i] * v[i];
+        }
+
+        if ( w_norm == 0.0 )
+        {
+          return 0.0; // f doesn't change along v
+        }
+
+        rho    = std::sqrt( w_norm ) / delta;
+        v_norm = w_norm;
+      }
+
+      return rho;
+    }
+
+  public:
+    /// \param rhs The right-hand side of the system
+    /// \param stability_boundary The stability interval of the explicit stepper on the negative real axis (about 3 for RK45)
+    explicit AutoSwitch_TimeStepper( const RHS* rhs, double stability_boundary = 3.0 )
+        : TimeStepper<RHS>( rhs ), m_explicit( rhs ), m_implicit( rhs ), m_stability_boundary( stability_boundary )
+    {
+    }
+
+    /// \param rhs The right-hand side of the system
+    /// \param explicit_args, implicit_args The arguments of the steppers after the RHS (e.g. their tolerances)
+    /// \param stability_boundary The stability interval of the explicit stepper on the negative real axis (about 3 for RK45)
+    template<typename... ExplicitArgs, typename... ImplicitArgs>
+    AutoSwitch_TimeStepper( const RHS* rhs, std::tuple<ExplicitArgs...> explicit_args, std::tuple<ImplicitArgs...> implicit_args,
+                            double stability_boundary = 3.0 )
+        : TimeStepper<RHS>( rhs ),
+          m_explicit( std::make_from_tuple<ExplicitTS>( std::tuple_cat( std::make_tuple( rhs ), explicit_args ) ) ),
+          m_implicit( std::make_from_tuple<ImplicitTS>( std::tuple_cat( std::make_tuple( rhs ), implicit_args ) ) ),
+          m_stability_boundary( stability_boundary )
+    {
+    }
+
+    /// \brief If the implicit stepper is used now
+    [[nodiscard]] bool isStiff() const
+    {
+      return m_stiff;
+    }
+
+    /// \brief The last estimate of the spectral radius of the Jacobian
+    [[nodiscard]] double spectralRadius() const
+    {
+      return m_spectral_radius;
+    }
+
+    /// \brief The number of the switches between the steppers
+    [[nodiscard]] int switches() const
+    {
+      return m_switches;
+    }
+
+    /// \brief The RHS calls of the stiffness estimates and of both steppers
+    [[nodiscard]] long rhsCalls() const override
+    {
+      return this->m_rhs_calls + m_explicit.rhsCalls() + m_implicit.rhsCalls();
+    }
+
+    [[nodiscard]] long rejections() const override
+    {
+      return m_explicit.rejections() + m_implicit.rejections();
+    }
+
+    [[nodiscard]] long iterations() const override
+    {
+      return m_explicit.iterations() + m_implicit.iterations();
+    }
+
+    void setStepInterval( double begin, double end ) const override
+    {
+      TimeStepper<RHS>::setStepInterval( begin, end );
+      m_explicit.setStepInterval( begin, end );
+      m_implicit.setStepInterval( begin, end );
+    }
+
+    /// \brief Resets both steppers, the stiffness is estimated again on the next step
+    void reset() const override
+    {
+      m_explicit.reset();
+      m_implicit.reset();
+      m_stiff             = false;
+      m_steps_since_check = check_interval;
+      std::fill( m_last_step, m_last_step + RHS::N, 0.0 );
+    }
+
+    void save( StepperSnapshot& snapshot ) const override
+    {
+      m_explicit.save( snapshot );
+      m_implicit.save( snapshot );
+      snapshot.put( m_stiff );
+      snapshot.put( m_steps_since_check );
+      snapshot.put( m_spectral_radius );
+      snapshot.put( m_last_step, RHS::N );
+    }
+
+    void load( StepperSnapshot& snapshot ) const override
+    {
+      m_explicit.load( snapshot );
+      m_implicit.load( snapshot );
+      snapshot.get( m_stiff );
+      snapshot.get( m_steps_since_check );
+      snapshot.get( m_spectral_radius );
+      snapshot.get( m_last_step, RHS::N );
+    }
+
+    /// \brief The stepper function
+    /// \param current_time The current time
+    /// \param current_state The current state of the system
+    /// \param next_state The next state of the system
+    /// \return The next time (current_time + dt) and the suggested next delta time
+
+    std::pair<double, double>
+    operator()( double current_state[RHS::N], double next_state[RHS::N], double current_time, double suggested_d_time = 1e-3 ) const override
+    {
+      if ( m_steps_since_check >= check_interval )
+      {
+        m_steps_since_check = 0;
+        m_spectral_radius   = estimate_spectral_radius( current_time, current_state );
+
+        double h_rho = suggested_d_time * m_spectral_radius;
+        bool   stiff = m_stiff ? h_rho >= to_explicit_margin * m_stability_boundary
+                               : h_rho >= to_implicit_margin * m_stability_boundary;
+
+        if ( stiff != m_stiff )
+        {
+          m_stiff = stiff;
+          m_switches++;
+
+          // The stepper taking over forgets its data of its last active stretch (e.g. FSAL, the Newton rate)
+          if ( m_stiff )
+          {
+            m_implicit.reset();
+          }
+          else
+          {
+            m_explicit.reset();
+          }
+        }
+      }
+      m_steps_since_check++;
+
+      auto result = m_stiff ? m_implicit( current_state, next_state, current_time, suggested_d_time )
+                            : m_explicit( current_state, next_state, current_time, suggested_d_time );
+
+      for ( int i = 0; i < RHS::N; ++i )
+      {
+        m_last_step[i] = next_state[i] - current_state[i];
+      }
+
+      return result;
+    }
+
+    void dense_output( double t, double state[RHS::N] ) const override
+    {
+      if ( m_stiff )
+      {
+        m_implicit.dense_output( t, state );
+      }
+      else
+      {
+        m_explicit.dense_output( t, state );
+      }
+    }
+  }; // class AutoSwitch_TimeStepper
+} // namespace ADAAI::Integration::Integrator::Stepper
@@ -1,6 +1,18 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "../../../utils/Consts.hpp"
 #include "../RHS.hpp"
+#include "../Snapshot.hpp"
+#include "../State.hpp"
+#include "../Statistics.hpp"
 
 namespace ADAAI::Integration::Integrator::Stepper
 {
@@ -10,6 +22,63 @@ namespace ADAAI::Integration::Integrator::Stepper
   protected:
     const RHS* m_rhs;
 
+    mutable std::atomic<long> m_rhs_calls  = 0; // The RHS calls (including the finite-difference Jacobians)
+    mutable long              m_rejections = 0; // The rejected step attempts
+    mutable long              m_iterations = 0; // The Newton / corrector iterations
+
+    Arena  m_own_arena;
+    Arena* m_arena = &m_own_arena; // The scratch memory of the steps of the runtime-sized systems
+
+    // The step being integrated (see setStepInterval)
+    mutable double m_step_begin = -std::numeric_limits<double>::infinity();
+    mutable double m_step_end   = std::numeric_limits<double>::infinity();
+
+    /// \brief Calls the RHS and counts the call (the parallel steppers call it from several threads)
+    void call_rhs( double t, const double* y, double* f ) const
+    {
+      if constexpr ( StatisticsEnabled )
+      {
+        m_rhs_calls.fetch_add( 1, std::memory_order_relaxed );
+      }
+      ( *m_rhs )( rhs_time( t ), y, f );
+    }
+
+    /// \brief The time the RHS is evaluated at instead of t (the Jacobians are evaluated there too)
+    /// \details A breakpoint of the RHS at an end of the step being integrated is moved one ulp into the step, so
+    ///          the coefficients that jump there (whichever side they are closed on) take their limit from inside
+    ///          the step. The end t0 + h of the step can miss the breakpoint by the roundoff.
+    double rhs_time( double t ) const
+    {
+      if constexpr ( BreakpointRHS<RHS> )
+      {
+        auto at = [t]( double end )
+        {
+          return std::isfinite( end ) && IsBreakpoint<RHS>( end ) && std::abs( t - end ) <= 4.0 * CONST::EPS<double> * std::abs( end );
+        };
+        if ( at( m_step_end ) )
+        {
+          return std::nextafter( m_step_end, m_step_begin );
+        }
+        if ( at( m_step_begin ) )
+        {
+          return std::nextafter( m_step_begin, m_step_end );
+        }
+      }
+      return t;
+    }
+
+    /// \brief Throws if the step of a retried attempt is lost in the roundoff of the time or is not a number
+    /// \details The adaptive steppers call it before every attempt, so a step that keeps being rejected
+    ///          (e.g. at a singularity or with a NaN in the state) stops the integration instead of looping forever
+    /// \param name The name of the stepper (for the message)
+    static void check_step( const char* name, double t, double h )
+    {
+      if ( !( std::abs( h ) > 4.0 * CONST::EPS<double> * std::max( std::abs( t ), std::abs( t + h ) ) ) )
+      {
+        throw std::runtime_error( std::string( name ) + ": The step size underflowed at t = " + std::to_string( t ) );
+      }
+    }
+
   public:
     constexpr static int N = RHS::N;
 
@@ -18,6 +87,32 @@ namespace ADAAI::Integration::Integrator::Stepper
     {
     }
 
+    /// \brief The number of equations
+    [[nodiscard]] int size() const
+    {
+      return StateSize( *m_rhs );
+    }
+
+    /// \brief Shares an arena with the other steppers and solves of the thread (the stepper has its own by default)
+    void setArena( Arena* arena )
+    {
+      m_arena = arena;
+    }
+
+    [[nodiscard]] Arena& arena() const
+    {
+      return *m_arena;
+    }
+
+    /// \brief Sets the step being integrated: the RHS takes the one-sided limits at its ends (see rhs_time)
+    /// \details The integrator sets it before every step to [the current time, the next stop time], the stepper
+    ///          used alone evaluates the RHS at the breakpoints as they are
+    virtual void setStepInterval( double begin, double end ) const
+    {
+      m_step_begin = begin;
+      m_step_end   = end;
+    }
+
     /// \brief The stepper function
     /// \param current_time The current time
     /// \param current_state The current state of the system
@@ -25,68 +120,92 @@ namespace ADAAI::Integration::Integrator::Stepper
     /// \return The next time (current_time + dt) and the delta time
 
     virtual std::pair<double, double>
-    operator()( double current_state[N], double next_state[N], double current_time, double suggested_d_time ) const = 0;
-  }; // class Stepper
+    operator()( double current_state[], double next_state[], double current_time, double suggested_d_time ) const = 0;
 
-  template<typename RHS>
-  class DiscreteTimeStepper : public TimeStepper<RHS>
-  {
-  public:
-    explicit DiscreteTimeStepper( const RHS* rhs )
-        : TimeStepper<RHS>( rhs )
+    /// \brief Forgets the data carried across the steps (the next step starts a new trajectory)
+    /// \details The integrator calls it before the first step, so a stepper with a history
+    ///          (e.g. multistep methods) doesn't continue the previous integration
+    virtual void reset() const
     {
     }
 
-    std::pair<double, double>
-    operator()( double current_state[RHS::N], double next_state[RHS::N], double current_time, double suggested_d_time = 1e-2 ) const override
+    /// \brief Appends the data carried across the steps (the one 'reset' forgets) to the snapshot
+    /// \details After 'load' the steps from the saved state are bitwise the same as the ones the saving
+    ///          stepper would have made (the checkpoints of the integrator)
+    virtual void save( [[maybe_unused]] StepperSnapshot& snapshot ) const
     {
-      double rhs[RHS::N] {};
-      ( *this->m_rhs )( current_time, current_state, rhs );
-
-      for ( int i = 0; i < RHS::N; ++i )
-        next_state[i] = current_state[i] + suggested_d_time * rhs[i];
+    }
 
-      return { current_time + suggested_d_time, suggested_d_time };
+    /// \brief Restores the data appended by 'save'
+    virtual void load( [[maybe_unused]] StepperSnapshot& snapshot ) const
+    {
     }
-  }; // class DiscreteTimeStepper
 
-  template<typename RHS>
-  class GSLTimeStepper : public TimeStepper<RHS>
-  {
-    // gsl_odeiv2_driver* m_driver;
+    /// \brief The RHS calls since the stepper was created
+    [[nodiscard]] virtual long rhsCalls() const
+    {
+      return m_rhs_calls.load( std::memory_order_relaxed );
+    }
 
-  public:
-    explicit GSLTimeStepper( const RHS* rhs )
-        : TimeStepper<RHS>( rhs )
+    /// \brief The rejected step attempts since the stepper was created
+    [[nodiscard]] virtual long rejections() const
     {
-      // gsl_odeiv2_system system = { fakeRHS, nullptr, RHS::N, nullptr };
-      // m_driver = gsl_odeiv2_driver_alloc_y_new( &system, &gsl_odeiv2_step_rkf45, 1e-2, 1e-4, 1e-4 );
+      return m_rejections;
+    }
 
-      throw std::runtime_error( "I don't have GSL installed, so this code is not implemented :(\n\nPS: Very typical error in production code" );
+    /// \brief The Newton / corrector iterations since the stepper was created (zero for the explicit steppers)
+    [[nodiscard]] virtual long iterations() const
+    {
+      return m_iterations;
     }
 
-    int fakeRHS( double t, const double y[], double f[], void* params )
+    /// \brief Continuous extension (dense output) of the last completed step
+    /// \param t The time inside the last step ([t_n, t_n + dt])
+    /// \param state The interpolated state of the system at t
+    virtual void dense_output( [[maybe_unused]] double t, [[maybe_unused]] double state[] ) const
     {
-      ( *this->m_rhs )( t, y, f );
+      throw std::runtime_error( "Dense output is not supported by this stepper" );
+    }
+  }; // class Stepper
+
+  template<typename RHS>
+  class DiscreteTimeStepper : public TimeStepper<RHS>
+  {
+    // The last step data (for dense output)
+    mutable double m_t0 = 0.0;
+    mutable double m_y0[RHS::N] {};
+    mutable double m_f0[RHS::N] {};
 
-      // return GSL_SUCCESS;
-      return 0;
+  public:
+    explicit DiscreteTimeStepper( const RHS* rhs )
+        : TimeStepper<RHS>( rhs )
+    {
     }
 
     std::pair<double, double>
     operator()( double current_state[RHS::N], double next_state[RHS::N], double current_time, double suggested_d_time = 1e-2 ) const override
     {
-      double current_time_copy = current_time;
-      // int status = gsl_odeiv2_driver_apply( m_driver, &current_time, current_time + suggested_d_time, current_state );
+      double rhs[RHS::N] {};
+      this->call_rhs( current_time, current_state, rhs );
 
-      // if ( status != GSL_SUCCESS )
-      // {
-      //   throw std::runtime_error( "GSL integration failed" );
-      // }
+      for ( int i = 0; i < RHS::N; ++i )
+        next_state[i] = current_state[i] + suggested_d_time * rhs[i];
+
+      m_t0 = current_time;
+      for ( int i = 0; i < RHS::N; ++i )
+      {
+        m_y0[i] = current_state[i];
+        m_f0[i] = rhs[i];
+      }
 
-      // return { current_time, current_time - current_time_copy };
+      return { current_time + suggested_d_time, suggested_d_time };
+    }
 
-      throw std::runtime_error( "Still not implemented :(" );
+    /// \brief Euler's continuous extension is the line through the step
+    void dense_output( double t, double state[RHS::N] ) const override
+    {
+      for ( int i = 0; i < RHS::N; ++i )
+        state[i] = m_y0[i] + ( t - m_t0 ) * m_f0[i];
     }
-  }; // class GSLTimeStepper
+  }; // class DiscreteTimeStepper
 } // namespace ADAAI::Integration::Integrator::Stepper
@@ -0,0 +1,370 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../ThreadPool.hpp"
+#include "BasicTimeStepper.hpp"
+#include "DenseOutput.hpp"
+
+namespace ADAAI::Integration::Integrator::Stepper
+{
+  /// \brief The Gragg-Bulirsch-Stoer extrapolation stepper
+  /// \details Column j of the extrapolation table is the modified midpoint method with n_j = 2 (j + 1) substeps,
+  ///          the table is extrapolated to the zero substep in h^2 (Aitken-Neville). T[j][j] is of order 2 (j + 1).
+  ///          The order (the column) and the step are chosen by minimal work per unit step as in E. Hairer's ODEX:
+  ///          the step is accepted in the columns k - 1, k or k + 1 of the target k, it is rejected early if the
+  ///          error isn't expected to converge by k + 1, and the target moves by at most one column per step.
+  ///          The columns are independent, so they can be computed on the workers of a thread pool. It pays off only
+  ///          for the expensive RHS: a column of a cheap one takes less time than the wake-up of a worker.
+  ///          The extrapolation needs a smooth RHS over the whole step. Across a kink (e.g. the layers of the air or
+  ///          the drag table of the cannonball) the table converges to a wrong limit and the error estimate can't see
+  ///          it, use an embedded Runge-Kutta pair for such a RHS.
+  template<typename RHS>
+  class BulirschStoer_TimeStepper : public TimeStepper<RHS>
+  {
+    constexpr static int max_columns = 9; // n_j up to 18, order up to 18
+
+    constexpr static double safety            = 0.94;
+    constexpr static double error_safety      = 0.65;
+    constexpr static double max_step_growth   = 4.0;
+    constexpr static double max_step_decrease = 0.02;
+    constexpr static double order_decrease    = 0.8; // The lower column is taken if its work per unit step is smaller by this
+    constexpr static double order_increase    = 0.9; // The higher column is taken if the work per unit step drops by this
+
+    double m_atol;
+    double m_rtol;
+
+    std::unique_ptr<ThreadPool> m_pool; // The workers of the columns (none: serial)
+
+    int m_substeps[max_columns]; // n_j
+    int m_work[max_columns];     // A_j: the RHS calls for the columns 0...j (including f0)
+    int m_initial_column;        // The first target column (by the tolerance as in ODEX)
+
+    mutable int m_column; // The target column k of the next step
+
+    // The extrapolation table T[j][l] (j * (j + 1) / 2 + l rows of N), per instance (the table can be big)
+    mutable std::vector<double> m_table;
+    mutable std::vector<double> m_midpoint; // The scratch of the modified midpoint method, per column
+
+    // The last step data (for dense output)
+    mutable double m_t0 = 0.0;
+    mutable double m_h  = 0.0;
+    mutable double m_y0[RHS::N] {};
+    mutable double m_f0[RHS::N] {};
+    mutable double m_y1[RHS::N] {};
+    mutable double m_f1[RHS::N] {};
+    mutable bool   m_f1_ready = false; // f(t0 + h, y1) is evaluated lazily by the first dense_output call
+
+    double* table( int j, int l ) const
+    {
+      return m_table.data() + static_cast<std::size_t>( j * ( j + 1 ) / 2 + l ) * RHS::N;
+    }
+
+    /// \brief The modified midpoint method with n_j substeps (T[j][0]), uses f0 = f(t0, y0)
+    void midpoint( int j, double t0, double H, const double* y0, const double* f0 ) const
+    {
+      const int n = m_substeps[j];
+      double    h = H / n;
+
+      double* z_prev = m_midpoint.data() + static_cast<std::size_t>( 3 * j ) * RHS::N;
+      double* z      = z_prev + RHS::N;
+      double* f      = z + RHS::N;
+      double* result = table( j, 0 );
+
+      for ( int i = 0; i < RHS::N; ++i )
+      {
+        z_prev[i] = y0[i];
+        z[i]      = y0[i] + h * f0[i];
+      }
+
+      for ( int m = 1; m < n; ++m )
+      {
+        this->call_rhs( t0 + m * h, z, f );
+        for ( int i = 0; i < RHS::N; ++i )
+        {
+          double z_next = z_prev[i] + 2.0 * h * f[i];
+          z_prev[i]     = z[i];
+          z[i]          = z_next;
+        }
+      }
+
+      std::memcpy( result, z, RHS::N * sizeof( double ) );
+    }
+
+    /// \brief Fills row j of the table from T[j][0]
+    void extrapolate( int j ) const
+    {
+      for ( int l = 1; l <= j; ++l )
+      {
+        double  ratio    = static_cast<double>( m_substeps[j] ) / m_substeps[j - l];
+        double  divisor  = ratio * ratio - 1.0;
+        double* current  = table( j, l );
+        double* left     = table( j, l - 1 );
+        double* previous = table( j - 1, l - 1 );
+
+        for ( int i = 0; i < RHS::N; ++i )
+        {
+          current[i] = left[i] + ( left[i] - previous[i] ) / divisor;
+        }
+      }
+    }
+
+    /// \brief The error estimate of T[j][j - 1] (scaled RMS of T[j][j] - T[j][j - 1])
+    double error_norm( int j, const double* y0 ) const
+    {
+      const double* best   = table( j, j );
+      const double* second = table( j, j - 1 );
+
+      double sum = 0.0;
+      for ( int i = 0; i < RHS::N; ++i )
+      {
+        double scale = m_atol + m_rtol * std::max( std::abs( y0[i] ), std::abs( best[i] ) );
+        double error = ( best[i] - second[i] ) / scale;
+        sum += error * error;
+      }
+      return std::sqrt( sum / RHS::N );
+    }
+
+    /// \brief The step proposed by the error of column j
+    double step_for( int j, double error, double H ) const
+    {
+      double factor = error > 0.0    ? safety * std::pow( error_safety / error, 1.0 / ( 2 * j + 1 ) )
+                    : error == 0.0 ? max_step_growth
+                                   : max_step_decrease; // A NaN error shrinks the step until it underflows
+      return H * std::clamp( factor, max_step_decrease, max_step_growth );
+    }
+
+    /// \brief Computes the rows [first, last] of the table
+    void compute_rows( int first, int last, double t0, double H, const double* y0, const double* f0 ) const
+    {
+      if ( m_pool && last > first )
+      {
+        // The longest columns first, so the short ones fill the gaps
+        m_pool->parallel_for( last - first + 1, [&]( int index, [[maybe_unused]] int worker )
+                              { midpoint( last - index, t0, H, y0, f0 ); } );
+      }
+      else
+      {
+        for ( int j = first; j <= last; ++j )
+        {
+          midpoint( j, t0, H, y0, f0 );
+        }
+      }
+
+      for ( int j = std::max( first, 1 ); j <= last; ++j )
+      {
+        extrapolate( j );
+      }
+    }
+
+  public:
+    /// \param rhs The right-hand side of the system
+    /// \param atol, rtol The absolute and relative tolerances of the local error
+    /// \param parallel If true the columns of the table are computed on a thread pool (the RHS must be thread safe)
+    explicit BulirschStoer_TimeStepper( const RHS* rhs, double atol = 1e-12, double rtol = 1e-12, bool parallel = false )
+        : TimeStepper<RHS>( rhs ), m_atol( atol ), m_rtol( rtol ),
+          m_table( static_cast<std::size_t>( max_columns * ( max_columns + 1 ) / 2 ) * RHS::N ),
+          m_midpoint( static_cast<std::size_t>( 3 * max_columns ) * RHS::N )
+    {
+      for ( int j = 0; j < max_columns; ++j )
+      {
+        m_substeps[j] = 2 * ( j + 1 );
+        m_work[j]     = ( j == 0 ? 1 : m_work[j - 1] ) + m_substeps[j] - 1;
+      }
+
+      m_initial_column = std::clamp( static_cast<int>( -std::log10( rtol + 1e-40 ) * 0.6 + 0.5 ), 1, max_columns - 2 );
+      m_column         = m_initial_column;
+
+      if ( parallel )
+      {
+        int threads = std::min<int>( max_columns, std::max( 1u, std::thread::hardware_concurrency() ) );
+        m_pool      = std::make_unique<ThreadPool>( threads );
+      }
+    }
+
+    /// \brief The target column of the next step (its order is 2 * (column + 1))
+    [[nodiscard]] int column() const
+    {
+      return m_column;
+    }
+
+    void reset() const override
+    {
+      m_column = m_initial_column;
+    }
+
+    void save( StepperSnapshot& snapshot ) const override
+    {
+      snapshot.put( m_column );
+    }
+
+    void load( StepperSnapshot& snapshot ) const override
+    {
+      snapshot.get( m_column );
+    }
+
+    /// \brief The stepper function
+    /// \param current_time The current time
+    /// \param current_state The current state of the system
+    /// \param next_state The next state of the system
+    /// \return The next time (current_time + dt) and the suggested next delta time
+
+    std::pair<double, double>
+    operator()( double current_state[RHS::N], double next_state[RHS::N], double current_time, double suggested_d_time = 1e-2 ) const override
+    {
+      double H = suggested_d_time;
+
+      this->call_rhs( current_time, current_state, m_f0 );
+
+      double errors[max_columns] {};
+      double steps[max_columns] {};
+      double rates[max_columns] {}; // The work per unit step A_j / H_j
+      bool   rejected = false;
+
+      auto square = []( double x )
+      {
+        return x * x;
+      };
+
+      while ( true )
+      {
+        this->check_step( "BulirschStoer_TimeStepper", current_time, H );
+
+        const int k = m_column;
+
+        // The columns up to k - 1 are always needed, k + 1 only if k doesn't converge. In parallel the column k is
+        // computed with the others
+        compute_rows( 0, m_pool ? k : k - 1, current_time, H, current_state, m_f0 );
+
+        int  last     = 0; // The last column of the attempt
+        bool accepted = false;
+        for ( int j = 1; j <= k + 1; ++j )
+        {
+          if ( j > ( m_pool ? k : k - 1 ) )
+          {
+            compute_rows( j, j, current_time, H, current_state, m_f0 );
+          }
+
+          errors[j] = error_norm( j, current_state );
+          steps[j]  = step_for( j, errors[j], H );
+          rates[j]  = m_work[j] / steps[j];
+          last      = j;
+
+          // The column k - 1 is tested only if the last attempt hasn't failed (as in ODEX)
+          if ( j < k - 1 || ( j == k - 1 && rejected ) )
+          {
+            continue;
+          }
+          if ( errors[j] <= 1.0 )
+          {
+            accepted = true;
+            break;
+          }
+
+          // The convergence monitor: the error isn't expected to drop below 1 by the column k + 1
+          double expected = j == k - 1 ? square( m_substeps[k + 1] * m_substeps[k] / double( m_substeps[0] * m_substeps[0] ) )
+                          : j == k     ? square( m_substeps[k + 1] / double( m_substeps[0] ) )
+                                       : 0.0;
+          if ( errors[j] > expected )
+          {
+            break;
+          }
+        }
+
+        if ( !accepted )
+        {
+          ++this->m_rejections;
+          rejected = true;
+
+          int column = std::min( k, last );
+          if ( column > 1 && rates[column - 1] < order_decrease * rates[column] )
+          {
+            --column;
+          }
+          m_column = column;
+          H        = steps[column];
+          continue;
+        }
+
+        // The next column: the minimal work per unit step among the neighbours of the accepted one
+        const int c = last;
+
+        int next_column;
+        if ( c == 1 )
+        {
+          next_column = rejected ? 1 : std::min( 2, max_columns - 2 );
+        }
+        else if ( c <= k )
+        {
+          next_column = c;
+          if ( rates[c - 1] < order_decrease * rates[c] )
+          {
+            next_column = c - 1;
+          }
+          if ( rates[c] < order_increase * rates[c - 1] )
+          {
+            next_column = std::min( c + 1, max_columns - 2 );
+          }
+        }
+        else
+        {
+          next_column = c - 1;
+          if ( c > 2 && rates[c - 2] < order_decrease * rates[c - 1] )
+          {
+            next_column = c - 2;
+          }
+          if ( rates[c] < order_increase * rates[next_column] )
+          {
+            next_column = std::min( c, max_columns - 2 );
+          }
+        }
+
+        double next_step;
+        if ( rejected )
+        {
+          // No increase of the order or the step right after a rejection
+          next_column = std::min( next_column, c );
+          next_step   = std::min( H, steps[next_column] );
+        }
+        else if ( next_column <= c )
+        {
+          next_step = steps[next_column];
+        }
+        else
+        {
+          // The higher column hasn't been computed: its step is the one of c scaled by the work
+          next_step = steps[c] * m_work[next_column] / m_work[c];
+        }
+
+        m_column = next_column;
+
+        std::memcpy( next_state, table( c, c ), sizeof( m_y1 ) );
+
+        m_t0       = current_time;
+        m_h        = H;
+        m_f1_ready = false;
+        std::memcpy( m_y0, current_state, sizeof( m_y0 ) );
+        std::memcpy( m_y1, next_state, sizeof( m_y1 ) );
+
+        return { current_time + H, next_step };
+      }
+    }
+
+    void dense_output( double t, double state[RHS::N] ) const override
+    {
+      if ( !m_f1_ready )
+      {
+        this->call_rhs( m_t0 + m_h, m_y1, m_f1 );
+        m_f1_ready = true;
+      }
+
+      HermiteInterpolation( ( t - m_t0 ) / m_h, m_h, m_y0, m_f0, m_y1, m_f1, state, RHS::N );
+    }
+  }; // class BulirschStoer_TimeStepper
+} // namespace ADAAI::Integration::Integrator::Stepper
@@ -0,0 +1,307 @@
+#pragma once
+
+#include <array>
+
+namespace ADAAI::Integration::Integrator::Stepper
+{
+  /// \brief The Butcher tableau of an explicit Runge-Kutta method with 'S' stages
+  /// \details k_i = f(t + c_i h, y + h sum_{j<i} a_ij k_j), y_1 = y + h sum b_i k_i.
+  ///          The embedded solution y + h sum b_hat_i k_i estimates the local error (embedded_order 0: no estimate).
+  template<int S>
+  struct ButcherTableau
+  {
+    constexpr static int stages = S;
+
+    std::array<std::array<double, S>, S> a {};
+    std::array<double, S>                b {};
+    std::array<double, S>                b_hat {};
+    std::array<double, S>                c {};
+
+    int order          = 0;
+    int embedded_order = 0;
+
+    /// \brief The last stage is evaluated at (t + h, y_1), so it is the first stage of the next step (FSAL)
+    [[nodiscard]] constexpr bool fsal() const
+    {
+      if ( c[S - 1] != 1.0 || b[S - 1] != 0.0 )
+      {
+        return false;
+      }
+      for ( int j = 0; j < S - 1; ++j )
+      {
+        if ( a[S - 1][j] != b[j] )
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    /// \brief The consistency of the coefficients: the rows of a sum to c, b and b_hat sum to 1
+    [[nodiscard]] constexpr bool consistent( double tolerance = 1e-14 ) const
+    {
+      auto close = [tolerance]( double x, double y )
+      {
+        return x - y <= tolerance && y - x <= tolerance;
+      };
+
+      double b_sum     = 0.0;
+      double b_hat_sum = 0.0;
+      for ( int i = 0; i < S; ++i )
+      {
+        double row_sum = 0.0;
+        for ( int j = 0; j < S; ++j )
+        {
+          if ( j >= i && a[i][j] != 0.0 )
+          {
+            return false; // Not explicit
+          }
+          row_sum += a[i][j];
+        }
+        if ( !close( row_sum, c[i] ) )
+        {
+          return false;
+        }
+        b_sum += b[i];
+        b_hat_sum += b_hat[i];
+      }
+      return close( b_sum, 1.0 ) && ( embedded_order == 0 || close( b_hat_sum, 1.0 ) );
+    }
+
+    /// \brief The order conditions of b up to 'order' and of b_hat up to 'embedded_order' (at most 8)
+    /// \details A rooted tree t = [t_1, ..., t_m] has the stage weights Phi_i(t) = prod_k (A Phi(t_k))_i and the density
+    ///          gamma(t) = |t| prod_k gamma(t_k), where Phi(.) = 1 and A Phi(.) = c for the single node. The condition
+    ///          of t is sum b_i Phi_i(t) = 1 / gamma(t). The trees of order n are the multisets of the smaller trees
+    ///          with n - 1 nodes in all (1, 1, 2, 4, 9, 20, 48, 115 of them).
+    [[nodiscard]] constexpr bool satisfiesOrderConditions( double tolerance = 1e-14 ) const
+    {
+      constexpr int max_order = 8;
+      constexpr int max_trees = 200; // The trees up to order 8
+
+      struct Tree
+      {
+        int                   order   = 0;
+        double                density = 0.0;
+        std::array<double, S> phi {};   // Phi_i(t)
+        std::array<double, S> a_phi {}; // (A Phi(t))_i
+      };
+
+      const int last_order = order > embedded_order ? order : embedded_order;
+      if ( last_order > max_order )
+      {
+        return false;
+      }
+
+      std::array<Tree, max_trees> trees {};
+      int                         count = 0;
+
+      auto append = [&]( int tree_order, double density, const std::array<double, S>& phi )
+      {
+        Tree& tree   = trees[count++];
+        tree.order   = tree_order;
+        tree.density = density;
+        tree.phi     = phi;
+        for ( int i = 0; i < S; ++i )
+        {
+          for ( int j = 0; j < S; ++j )
+          {
+            tree.a_phi[i] += a[i][j] * phi[j];
+          }
+        }
+      };
+
+      // Adds the children t_k with index <= 'last' (so each multiset is taken once) to the trees of 'tree_order'
+      auto add_children = [&]( auto& self, int tree_order, int nodes, int last, const std::array<double, S>& phi, double density ) -> void
+      {
+        if ( nodes == 0 )
+        {
+          append( tree_order, tree_order * density, phi );
+          return;
+        }
+        for ( int k = last; k >= 0; --k )
+        {
+          if ( trees[k].order <= nodes )
+          {
+            std::array<double, S> product = phi;
+            for ( int i = 0; i < S; ++i )
+            {
+              product[i] *= trees[k].a_phi[i];
+            }
+            self( self, tree_order, nodes - trees[k].order, k, product, density * trees[k].density );
+          }
+        }
+      };
+
+      std::array<double, S> ones {};
+      ones.fill( 1.0 );
+
+      append( 1, 1.0, ones );
+      trees[0].a_phi = c;
+      for ( int tree_order = 2; tree_order <= last_order; ++tree_order )
+      {
+        add_children( add_children, tree_order, tree_order - 1, count - 1, ones, 1.0 );
+      }
+
+      auto satisfied = [&]( const std::array<double, S>& weights, const Tree& tree )
+      {
+        double sum = 0.0;
+        for ( int i = 0; i < S; ++i )
+        {
+          sum += weights[i] * tree.phi[i];
+        }
+        double residual = sum - 1.0 / tree.density;
+        return residual <= tolerance && -residual <= tolerance;
+      };
+
+      for ( int t = 0; t < count; ++t )
+      {
+        if ( trees[t].order <= order && !satisfied( b, trees[t] ) )
+        {
+          return false;
+        }
+        if ( trees[t].order <= embedded_order && !satisfied( b_hat, trees[t] ) )
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+  }; // struct ButcherTableau
+
+  /// \brief The classical 4th order Runge-Kutta method (no error estimate: the steps are fixed)
+  inline constexpr ButcherTableau<4> RK4 {
+      .a     = { { { 0.0, 0.0, 0.0, 0.0 },
+                   { 0.5, 0.0, 0.0, 0.0 },
+                   { 0.0, 0.5, 0.0, 0.0 },
+                   { 0.0, 0.0, 1.0, 0.0 } } },
+      .b     = { 1.0 / 6, 1.0 / 3, 1.0 / 3, 1.0 / 6 },
+      .b_hat = {},
+      .c     = { 0.0, 0.5, 0.5, 1.0 },
+      .order = 4,
+  };
+
+  /// \brief Fehlberg's 4(5) pair (the 5th order solution is propagated)
+  inline constexpr ButcherTableau<6> Fehlberg45 {
+      .a              = { { { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
+                            { 1.0 / 4, 0.0, 0.0, 0.0, 0.0, 0.0 },
+                            { 3.0 / 32, 9.0 / 32, 0.0, 0.0, 0.0, 0.0 },
+                            { 1932.0 / 2197, -7200.0 / 2197, 7296.0 / 2197, 0.0, 0.0, 0.0 },
+                            { 439.0 / 216, -8.0, 3680.0 / 513, -845.0 / 4104, 0.0, 0.0 },
+                            { -8.0 / 27, 2.0, -3544.0 / 2565, 1859.0 / 4104, -11.0 / 40, 0.0 } } },
+      .b              = { 16.0 / 135, 0.0, 6656.0 / 12825, 28561.0 / 56430, -9.0 / 50, 2.0 / 55 },
+      .b_hat          = { 25.0 / 216, 0.0, 1408.0 / 2565, 2197.0 / 4104, -1.0 / 5, 0.0 },
+      .c              = { 0.0, 1.0 / 4, 3.0 / 8, 12.0 / 13, 1.0, 1.0 / 2 },
+      .order          = 5,
+      .embedded_order = 4,
+  };
+
+  /// \brief Dormand-Prince 5(4) (DOPRI5, FSAL)
+  inline constexpr ButcherTableau<7> DormandPrince54 {
+      .a              = { { { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
+                            { 1.0 / 5, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
+                            { 3.0 / 40, 9.0 / 40, 0.0, 0.0, 0.0, 0.0, 0.0 },
+                            { 44.0 / 45, -56.0 / 15, 32.0 / 9, 0.0, 0.0, 0.0, 0.0 },
+                            { 19372.0 / 6561, -25360.0 / 2187, 64448.0 / 6561, -212.0 / 729, 0.0, 0.0, 0.0 },
+                            { 9017.0 / 3168, -355.0 / 33, 46732.0 / 5247, 49.0 / 176, -5103.0 / 18656, 0.0, 0.0 },
+                            { 35.0 / 384, 0.0, 500.0 / 1113, 125.0 / 192, -2187.0 / 6784, 11.0 / 84, 0.0 } } },
+      .b              = { 35.0 / 384, 0.0, 500.0 / 1113, 125.0 / 192, -2187.0 / 6784, 11.0 / 84, 0.0 },
+      .b_hat          = { 5179.0 / 57600, 0.0, 7571.0 / 16695, 393.0 / 640, -92097.0 / 339200, 187.0 / 2100, 1.0 / 40 },
+      .c              = { 0.0, 1.0 / 5, 3.0 / 10, 4.0 / 5, 8.0 / 9, 1.0, 1.0 },
+      .order          = 5,
+      .embedded_order = 4,
+  };
+
+  /// \brief Tsitouras 5(4) (Tsit5, FSAL): the coefficients are optimized for the error of the 5th order solution
+  /// \details Ch. Tsitouras, Runge-Kutta pairs of order 5(4) satisfying only the first column simplifying
+  ///          assumption, Computers & Mathematics with Applications 62 (2011). b_hat is b minus the error weights of the paper.
+  inline constexpr ButcherTableau<7> Tsitouras54 {
+      .a              = { { { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
+                            { 0.161, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
+                            { -0.008480655492356989, 0.335480655492357, 0.0, 0.0, 0.0, 0.0, 0.0 },
+                            { 2.897153057105493, -6.359448489975075, 4.3622954328695815, 0.0, 0.0, 0.0, 0.0 },
+                            { 5.325864828439257, -11.748883564062828, 7.4955393428898365, -0.09249506636175525, 0.0, 0.0, 0.0 },
+                            { 5.86145544294642, -12.92096931784711, 8.159367898576159, -0.071584973281401, -0.028269050394068383, 0.0, 0.0 },
+                            { 0.09646076681806523, 0.01, 0.4798896504144996, 1.379008574103742, -3.290069515436081, 2.324710524099774, 0.0 } } },
+      .b              = { 0.09646076681806523, 0.01, 0.4798896504144996, 1.379008574103742, -3.290069515436081, 2.324710524099774, 0.0 },
+      .b_hat          = { 0.09646076681806523 + 0.00178001105222577714,
+                          0.01 + 0.0008164344596567469,
+                          0.4798896504144996 - 0.007880878010261995,
+                          1.379008574103742 + 0.1447110071732629,
+                          -3.290069515436081 - 0.5823571654525552,
+                          2.324710524099774 + 0.45808210592918697,
+                          -1.0 / 66 },
+      .c              = { 0.0, 0.161, 0.327, 0.9, 0.9800255409045097, 1.0, 1.0 },
+      .order          = 5,
+      .embedded_order = 4,
+  };
+
+  /// \brief Verner's "most efficient" 6(5) pair (Vern6, 9 stages, FSAL)
+  /// \details J. H. Verner, Numerically optimal Runge-Kutta pairs with interpolants, Numerical Algorithms 53 (2010).
+  ///          b_hat is the 5th order solution that doesn't use the 7th stage.
+  ///          c, the stages 2-5 and b are the rationals of the paper (b is the solution of the quadrature conditions).
+  ///          The rationals of the stages 6-8 are too long for double: their rows solve sum a_ij c_j^(k-1) = c_i^k / k
+  ///          (k = 1, 2, 3) for a_i1, a_i3, a_i4 and are rounded to sum to c_i exactly. b_hat solves the quadrature
+  ///          conditions up to order 5 with b_hat_9 of the paper.
+  inline constexpr ButcherTableau<9> Verner65 {
+      .a              = { { { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
+                            { 3.0 / 50, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
+                            { 519479.0 / 27000000, 2070721.0 / 27000000, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
+                            { 1439.0 / 40000, 0.0, 4317.0 / 40000, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
+                            { 109225017611.0 / 82828840000, 0.0, -417627820623.0 / 82828840000, 43699198143.0 / 10353605000, 0.0, 0.0, 0.0, 0.0, 0.0 },
+                            { -41.872591664327516, 0.0, 159.4325621631375, -122.11921356501004, 5.531743066200054, 0.0, 0.0, 0.0, 0.0 },
+                            { -54.4301569353165, 0.0, 207.06725136501845, -158.61081378459, 6.991816585950243, -0.018597231062203123, 0.0, 0.0, 0.0 },
+                            { -54.66374178728199, 0.0, 207.9528062553894, -159.2889574744995, 7.018743740796948, -0.018338785905046104,
+                              -0.000511948499788209, 0.0, 0.0 },
+                            { 382735282417.0 / 11129397249634, 0.0, 0.0, 5535620703125000.0 / 21434089949505429, 13867056347656250.0 / 32943296570459319,
+                              626271188750.0 / 142160006043, -51160788125000.0 / 289890548217, 163193540017.0 / 946795234, 0.0 } } },
+      .b              = { 382735282417.0 / 11129397249634, 0.0, 0.0, 5535620703125000.0 / 21434089949505429, 13867056347656250.0 / 32943296570459319,
+                          626271188750.0 / 142160006043, -51160788125000.0 / 289890548217, 163193540017.0 / 946795234, 0.0 },
+      .b_hat          = { 0.0490996764838249, 0.0, 0.0, 0.22511122295165242, 0.4694682253029562, 0.8065792249988868, 0.0, -0.6071194891777931,
+                          0.0568611394404728 },
+      .c              = { 0.0, 3.0 / 50, 1439.0 / 15000, 1439.0 / 10000, 4973.0 / 10000, 389.0 / 400, 1999.0 / 2000, 1.0, 1.0 },
+      .order          = 6,
+      .embedded_order = 5,
+  };
+
+  /// \brief Prince-Dormand RK8(7)13M (13 stages, the 8th order solution is propagated)
+  /// \details P. J. Prince, J. R. Dormand, High order embedded Runge-Kutta formulae, J. Comp. Appl. Math. 7 (1981).
+  ///          The coefficients are the rational approximations of the paper.
+  inline constexpr ButcherTableau<13> PrinceDormand87 {
+      .a              = { { { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
+                            { 1.0 / 18, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
+                            { 1.0 / 48, 1.0 / 16, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
+                            { 1.0 / 32, 0.0, 3.0 / 32, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
+                            { 5.0 / 16, 0.0, -75.0 / 64, 75.0 / 64, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
+                            { 3.0 / 80, 0.0, 0.0, 3.0 / 16, 3.0 / 20, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
+                            { 29443841.0 / 614563906, 0.0, 0.0, 77736538.0 / 692538347, -28693883.0 / 1125000000, 23124283.0 / 1800000000,
+                              0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
+                            { 16016141.0 / 946692911, 0.0, 0.0, 61564180.0 / 158732637, 22789713.0 / 633445777, 545815736.0 / 2771057229,
+                              -180193667.0 / 1043307555, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
+                            { 39632708.0 / 573591083, 0.0, 0.0, -433636366.0 / 683701615, -421739975.0 / 2616292301, 100302831.0 / 723423059,
+                              790204164.0 / 839813087, 800635310.0 / 3783071287, 0.0, 0.0, 0.0, 0.0, 0.0 },
+                            { 246121993.0 / 1340847787, 0.0, 0.0, -37695042795.0 / 15268766246, -309121744.0 / 1061227803, -12992083.0 / 490766935,
+                              6005943493.0 / 2108947869, 393006217.0 / 1396673457, 123872331.0 / 1001029789, 0.0, 0.0, 0.0, 0.0 },
+                            { -1028468189.0 / 846180014, 0.0, 0.0, 8478235783.0 / 508512852, 1311729495.0 / 1432422823, -10304129995.0 / 1701304382,
+                              -48777925059.0 / 3047939560, 15336726248.0 / 1032824649, -45442868181.0 / 3398467696, 3065993473.0 / 597172653, 0.0, 0.0, 0.0 },
+                            { 185892177.0 / 718116043, 0.0, 0.0, -3185094517.0 / 667107341, -477755414.0 / 1098053517, -703635378.0 / 230739211,
+                              5731566787.0 / 1027545527, 5232866602.0 / 850066563, -4093664535.0 / 808688257, 3962137247.0 / 1805957418, 65686358.0 / 487910083, 0.0, 0.0 },
+                            { 403863854.0 / 491063109, 0.0, 0.0, -5068492393.0 / 434740067, -411421997.0 / 543043805, 652783627.0 / 914296604,
+                              11173962825.0 / 925320556, -13158990841.0 / 6184727034, 3936647629.0 / 1978049680, -160528059.0 / 685178525, 248638103.0 / 1413531060, 0.0, 0.0 } } },
+      .b              = { 14005451.0 / 335480064, 0.0, 0.0, 0.0, 0.0, -59238493.0 / 1068277825, 181606767.0 / 758867731, 561292985.0 / 797845732,
+                          -1041891430.0 / 1371343529, 760417239.0 / 1151165299, 118820643.0 / 751138087, -528747749.0 / 2220607170, 1.0 / 4 },
+      .b_hat          = { 13451932.0 / 455176623, 0.0, 0.0, 0.0, 0.0, -808719846.0 / 976000145, 1757004468.0 / 5645159321, 656045339.0 / 265891186,
+                          -3867574721.0 / 1518517206, 465885868.0 / 322736535, 53011238.0 / 667516719, 2.0 / 45, 0.0 },
+      .c              = { 0.0, 1.0 / 18, 1.0 / 12, 1.0 / 8, 5.0 / 16, 3.0 / 8, 59.0 / 400, 93.0 / 200, 5490023248.0 / 9719169821, 13.0 / 20,
+                          1201146811.0 / 1299019798, 1.0, 1.0 },
+      .order          = 8,
+      .embedded_order = 7,
+  };
+
+  static_assert( RK4.consistent() && Fehlberg45.consistent() && DormandPrince54.consistent() && Tsitouras54.consistent( 1e-12 ) );
+  static_assert( Verner65.consistent( 1e-13 ) && PrinceDormand87.consistent() );
+  static_assert( RK4.satisfiesOrderConditions() && Fehlberg45.satisfiesOrderConditions() && DormandPrince54.satisfiesOrderConditions() );
+  static_assert( Tsitouras54.satisfiesOrderConditions() && PrinceDormand87.satisfiesOrderConditions() );
+  static_assert( Verner65.satisfiesOrderConditions( 1e-12 ) ); // The b of the decimal rows 6 - 8 within 4.3e-13
+  static_assert( !RK4.fsal() && !Fehlberg45.fsal() && DormandPrince54.fsal() && Tsitouras54.fsal() );
+  static_assert( Verner65.fsal() && !PrinceDormand87.fsal() );
+} // namespace ADAAI::Integration::Integrator::Stepper
@@ -0,0 +1,29 @@
+#pragma once
+
+namespace ADAAI::Integration::Integrator::Stepper
+{
+  /// \brief Cubic Hermite interpolation inside the step [t0, t0 + h]
+  /// \details Uses the states and the derivatives at both ends of the step, so it is
+  ///          third order accurate and C^1 continuous across the steps
+  /// \param theta The relative position inside the step ((t - t0) / h)
+  /// \param h The step size
+  /// \param y0, f0 The state and its derivative at t0
+  /// \param y1, f1 The state and its derivative at t0 + h
+  /// \param state The interpolated state
+  /// \param size The number of equations
+  inline void HermiteInterpolation( double theta, double h, const double* y0, const double* f0, const double* y1, const double* f1, double* state, int size )
+  {
+    double theta2 = theta * theta;
+    double theta3 = theta2 * theta;
+
+    double h00 = 2.0 * theta3 - 3.0 * theta2 + 1.0;
+    double h10 = theta3 - 2.0 * theta2 + theta;
+    double h01 = -2.0 * theta3 + 3.0 * theta2;
+    double h11 = theta3 - theta2;
+
+    for ( int i = 0; i < size; ++i )
+    {
+      state[i] = h00 * y0[i] + h10 * h * f0[i] + h01 * y1[i] + h11 * h * f1[i];
+    }
+  }
+} // namespace ADAAI::Integration::Integrator::Stepper
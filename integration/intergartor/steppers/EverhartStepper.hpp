@@ -1,8 +1,12 @@
 
 #pragma once
 
+#include <array>
+#include <cmath>
 #include <cstring>
 #include <iostream>
+#include <stdexcept>
+#include <string>
 #include <valarray>
 #include <vector>
 
@@ -11,298 +15,431 @@
 
 namespace ADAAI::Integration::Integrator::Stepper
 {
-  template<typename RHS>
-  class Everhart_TimeStepper : public TimeStepper<RHS>
+  /// \brief Gauss-Radau spacings on [0, 1)
+  /// \details The roots of P_k(x) + P_{k+1}(x) (P_n are Legendre polynomials) mapped from [-1, 1) to [0, 1),
+  ///          the first one is always 0. For k = 7 these are the classical spacings of Everhart's RADAU15.
+  /// \tparam k The number of nodes besides 0
+  template<int k>
+  std::array<double, k + 1> GaussRadauSpacings()
   {
-  public:
-    explicit Everhart_TimeStepper( const RHS* rhs )
-        : TimeStepper<RHS>( rhs )
+    // P_n(x) and P_n'(x) by the Bonnet's recursion
+    auto legendre = []( int n, double x )
     {
-    }
-
-    constexpr static int N2 = RHS::N / 2;
-    constexpr static int k  = 5; // never change this number!
-
-    mutable double DD[k + 1][k + 1][N2]; // Divided Differences (DD[i][j] = F[t_i, ... , t_j])
-    mutable double F[k + 1][N2];
-    // second derivative of y at the points t_0...t_k
-    mutable double B[k + 1][N2];
-
-    mutable double y[k + 1][N2];
-    mutable double dy_dt[k + 1][N2];
+      double p0 = 1.0, p1 = x;
+      for ( int m = 1; m < n; m++ )
+      {
+        double p2 = ( ( 2 * m + 1 ) * x * p1 - m * p0 ) / ( m + 1 );
+        p0        = p1;
+        p1        = p2;
+      }
+      return std::pair<double, double> { p1, n * ( x * p1 - p0 ) / ( x * x - 1 ) };
+    };
 
-    mutable double state[RHS::N];
-    mutable double rhs_out[RHS::N];
+    std::array<double, k + 1> spacings {};
 
-    void initial_approximation_of_F( double t0, double h ) const
+    for ( int j = 1; j <= k; j++ )
     {
-      // F[i] = f(t, y(t), y'(t)) for t = t1, t2, ..., tk
-      // Notation: y*(t) := dy(t)/dt
-      //           y*(t) = dy_dt[0] + F[0] * (t - t_0)
-      //           y(t) = y[0] + dy_dt[0] * (t - t_0) + F_0 * (t - t_0)^2 / 2
-
-      double t0_initial = t0;
-
-      for ( int i = 0; i <= k; i++ )
+      // Chebyshev-Gauss-Radau points are close enough for Newton's method
+      double x = -std::cos( 2.0 * M_PI * j / ( 2 * k + 1 ) );
+      for ( int iteration = 0; iteration < 100; iteration++ )
       {
-        double delt_t = t0 - t0_initial;
+        auto [p_k, dp_k]   = legendre( k, x );
+        auto [p_k1, dp_k1] = legendre( k + 1, x );
 
-        // std::cout << delt_t << '\n';
+        double dx = ( p_k + p_k1 ) / ( dp_k + dp_k1 );
+        x -= dx;
 
-        // y[i] = y[0] + dy_dt[0] * (t0 - t_initial) + 0.5 * F[0] * (t0 - t_initial)^2
-        for ( int equation = 0; equation < N2; equation++ )
+        if ( std::abs( dx ) < CONST::EPS<double> )
         {
-          y[i][equation]  = y[0][equation] + dy_dt[0][equation] * delt_t + 0.5 * F[0][equation] * delt_t * delt_t;
-          state[equation] = y[i][equation];
-          // dy_dt[i] = dy_dt[0] + F[0] * (t0 - t0_initial)
-          dy_dt[i][equation]   = dy_dt[0][equation] + F[0][equation] * delt_t;
-          state[equation + N2] = dy_dt[i][equation];
+          break;
         }
+      }
 
-        ( *this->m_rhs )( t0, state, rhs_out );
+      spacings[j] = ( x + 1.0 ) / 2.0;
+    }
 
-        memcpy( F[i], rhs_out + N2, sizeof( F[0] ) * N2 );
+    return spacings;
+  }
 
-        // std::cout << "x: " << state[0] << " y: " << state[1] << " z: " << state[2] << '\n';
-        // std::cout << "v_x: " << state[3] << " v_y: " << state[4] << " v_z: " << state[5] << "\n";
-        // std::cout << "a_x: " << (rhs_out + N2)[0] << " a_y: " << (rhs_out + N2)[1] << " a_z: " << (rhs_out + N2)[2] << "\n";
-        // std::cout << "a_x: " << F[0][0] << " a_y: " << F[0][1] << " a_z: " << F[0][2] << "\n\n";
+  /// \brief Everhart's implicit Runge-Kutta-Nystrom integrator for y'' = f(t, y, y')
+  /// \details The state is (y, y'), RHS has to return (y', y''). The second derivative is approximated
+  ///          on the step by the polynomial F(t_0 + s * dt) = sum of B_j * (s * dt) ^ j over j = 0...k, that
+  ///          collocates f at the Gauss-Radau spacings s_0 = 0, s_1, ..., s_k.
+  /// \tparam RHS The right-hand side of the system
+  /// \tparam Order The order of the method (2k + 1, e.g. 7, 11 or 15 for RADAU15)
+  template<typename RHS, int Order = 15>
+  class Everhart_TimeStepper : public TimeStepper<RHS>
+  {
+    static_assert( Order % 2 == 1 && Order >= 5, "Everhart_TimeStepper: The order must be odd and at least 5" );
 
-        t0 += h;
-      }
-    }
+    double m_tolerance; // The relative size of the last B-term the step size is chosen for
+    double m_atol;      // The absolute part of the scale of the last B-term
+    double m_roundoff;  // The relative roundoff of the last B-term (the noise of the k-th divided difference of F)
 
-    double compute_F( double t0, double h ) const
-    {
-      // y(t) and dy(t)/dt
-      double t0_initial = t0;
+  public:
+    constexpr static int N2 = RHS::N / 2;
+    constexpr static int k  = ( Order - 1 ) / 2; // The number of substeps
 
-      static double old_y_k[N2];
+    constexpr static double max_step_growth   = 4.0;  // The next step is at most 4 times larger
+    constexpr static double min_step_decrease = 0.25; // The step is redone if it should be 4 times smaller
 
-      // Compute y(t) and dy(t)/dt using the formulas provided by L. Merkin
-      for ( int i = 1; i <= k; i++ )
+    /// \param rhs The right-hand side of the system
+    /// \param tolerance The relative size of the highest B-term in the step (B_k * dt^k / |F|) the step size is adapted to.
+    ///        It is raised to twice the roundoff of the B-term (about 5e-12 for the order 15): the smaller terms are noise
+    /// \param atol The absolute part of the scale of the B-term (atol + tolerance * |F|, in the units of F)
+    explicit Everhart_TimeStepper( const RHS* rhs, double tolerance = 1e-10, double atol = 0.0 )
+        : TimeStepper<RHS>( rhs ), m_tolerance( tolerance ), m_atol( atol )
+    {
+      // The divided difference of order k sums F_i / prod (s_i - s_j), so the roundoff of F is amplified by the sum of the weights
+      double weights = 0;
+      for ( int i = 0; i <= k; i++ )
       {
-        // (*) dy(t)/dt = [dy(t)/dt]|[t=t0] + sum of B_j * (t - t0) ^ (j + 1) / ( j + 1) over j = 0...k
-        t0 += h;
-
-        double delt_t = t0 - t0_initial;
-
-        for ( int equation = 0; equation < N2; equation++ )
+        double product = 1.0;
+        for ( int j = 0; j <= k; j++ )
         {
-          dy_dt[i][equation] = dy_dt[0][equation];
-          for ( int j = 0; j <= k; j++ )
-          {
-            double coeff = std::pow( delt_t, j + 1 ) / ( j + 1 );
-            dy_dt[i][equation] += B[j][equation] * coeff;
-          }
-          state[equation + N2] = dy_dt[i][equation];
+          product *= j != i ? std::abs( spacings[i] - spacings[j] ) : 1.0;
         }
+        weights += 1.0 / product;
+      }
+      m_roundoff  = CONST::EPS<double> * weights;
+      m_tolerance = std::max( m_tolerance, 2.0 * m_roundoff );
 
-        // (**) y(t) = y(t0) + [dy(t)/dt]|[t=t0] * (t - t0) + sum of B_j * (t - t0) ^ (j + 2) / (( j + 1) * (j + 2)) over j = 0...k
-        for ( int equation = 0; equation < N2; equation++ )
+      // s_i^(j + 1) / (j + 1) and s_i^(j + 2) / ((j + 1) * (j + 2)), the last row is for the end of the step (s = 1)
+      for ( int i = 0; i <= k + 1; i++ )
+      {
+        double s     = i <= k ? spacings[i] : 1.0;
+        double power = s;
+        for ( int j = 0; j <= k; j++ )
         {
-          if ( i == k )
-          {
-            old_y_k[equation] = y[k][equation];
-          }
+          dy_dt_coeff[i][j] = power / ( j + 1 );
+          power *= s;
+          y_coeff[i][j] = power / ( ( j + 1 ) * ( j + 2 ) );
+        }
+      }
 
-          y[i][equation] = y[0][equation] + dy_dt[0][equation] * ( delt_t );
-          for ( int j = 0; j <= k; j++ )
-          {
-            double coeff = std::pow( delt_t, j + 2 ) / ( ( j + 1 ) * ( j + 2 ) );
-            y[i][equation] += B[j][equation] * coeff;
-          }
-          state[equation] = y[i][equation];
+      // Coefficients of the Newton basis polynomials (s - s_0) * ... * (s - s_(m - 1)) in powers of s
+      for ( int m = 0; m <= k; m++ )
+      {
+        for ( int j = 0; j <= k; j++ )
+        {
+          newton_coeff[m][j] = m == 0 && j == 0 ? 1.0 : 0.0;
         }
-        // Now we know y(t) and dy(t)/dt at the points, so we can find F
+        if ( m == 0 )
+        {
+          continue;
+        }
+        for ( int j = 0; j <= m; j++ )
+        {
+          newton_coeff[m][j] = ( j > 0 ? newton_coeff[m - 1][j - 1] : 0.0 ) - spacings[m - 1] * newton_coeff[m - 1][j];
+        }
+      }
+    }
 
-        ( *this->m_rhs )( t0, state, rhs_out );
+    // The tables of the method (filled in the constructor, read-only afterwards)
+    const std::array<double, k + 1> spacings = GaussRadauSpacings<k>();
 
-        memcpy( F[i], rhs_out + N2, sizeof( state[0] ) * N2 );
-      }
+    double dy_dt_coeff[k + 2][k + 1];
+    double y_coeff[k + 2][k + 1];
+    double newton_coeff[k + 1][k + 1];
 
-      double norm_dy    = 0;
-      double norm_old_y = 0;
+    /// \brief The scratch data of a step (lives on the stack of 'operator()', so the stepper is reentrant)
+    struct Workspace
+    {
+      double DD[k + 1][N2]; // Divided Differences (DD[m] = F[s_0, ... , s_m])
+      double F[k + 1][N2];  // second derivative of y at the points s_0...s_k
+      // F(s) = sum of B_j * s ^ j (normalized to the step: B_j = B'_j * dt ^ j for the absolute B'_j)
+      double B[k + 1][N2];
 
-      for ( int i = 0; i < N2; i++ )
-      {
-        norm_dy += ( y[k][i] - old_y_k[i] ) * ( y[k][i] - old_y_k[i] );
-        norm_old_y += ( old_y_k[i] ) * ( old_y_k[i] );
-      }
+      double y[k + 1][N2];
+      double dy_dt[k + 1][N2];
 
-      return ( norm_dy / norm_old_y );
-    }
+      double state[RHS::N];
+      double rhs_out[RHS::N];
+    };
 
-    /// \brief Computes DD.
-    // F[i] must be computed before (using 'initial_approximation_of_F' or 'compute_F')
-    void compute_DD( double h ) const
+    /// \brief The last accepted step (for the dense output and the predictor of the next step)
+    struct History
     {
-      for ( int i = 0; i <= k - 1; i++ )
+      bool   has_last_step = false;
+      double last_t0       = 0.0;
+      double last_h        = 0.0;
+      double last_B[k + 1][N2];
+      double last_y0[RHS::N];    // The state at the start of the last step
+      double last_F_end[N2];     // F at the end of the last step (the start of the next one)
+      double last_state[RHS::N]; // The state at the end of the last step
+    };
+
+    mutable History m_history; // The only data that changes between the steps
+
+    /// \brief Evaluates y(t), dy(t)/dt at the point s_i (or at the end of the step for i = k + 1)
+    void compute_state( Workspace& ws, int i, double h, double* y_out, double* dy_dt_out ) const
+    {
+      // (*) dy(t)/dt = [dy(t)/dt]|[t=t0] + h * sum of B_j * s ^ (j + 1) / ( j + 1) over j = 0...k
+      // (**) y(t) = y(t0) + [dy(t)/dt]|[t=t0] * h * s + h^2 * sum of B_j * s ^ (j + 2) / (( j + 1) * (j + 2)) over j = 0...k
+      double s = i <= k ? spacings[i] : 1.0;
+
+      for ( int equation = 0; equation < N2; equation++ )
       {
-        for ( int index = 0; index < N2; index++ )
+        double dy = 0;
+        double yy = 0;
+        for ( int j = k; j >= 0; j-- )
         {
-          DD[i][i + 1][index] = ( F[i + 1][index] - F[i][index] ) / h;
+          dy += ws.B[j][equation] * dy_dt_coeff[i][j];
+          yy += ws.B[j][equation] * y_coeff[i][j];
         }
+
+        dy_dt_out[equation] = ws.dy_dt[0][equation] + h * dy;
+        y_out[equation]     = ws.y[0][equation] + h * ( ws.dy_dt[0][equation] * s + h * yy );
       }
-      for ( int order = 2; order <= k; order++ )
+    }
+
+    /// \brief Computes F[1...k] from the current B
+    void compute_F( Workspace& ws, double t0, double h ) const
+    {
+      for ( int i = 1; i <= k; i++ )
       {
-        for ( int index = 0; index < N2; index++ )
-        {
-          int vals = k + 1 - order;
-          for ( int j = 0; j < vals; j++ )
-          {
-            DD[j][j + order][index] = ( DD[j + 1][j + order][index] - DD[j][j + order - 1][index] ) / ( order * h );
-          }
-        }
+        compute_state( ws, i, h, ws.y[i], ws.dy_dt[i] );
+
+        memcpy( ws.state, ws.y[i], sizeof( ws.y[0] ) );
+        memcpy( ws.state + N2, ws.dy_dt[i], sizeof( ws.dy_dt[0] ) );
+
+        // Now we know y(t) and dy(t)/dt at the point, so we can find F
+        this->call_rhs( t0 + spacings[i] * h, ws.state, ws.rhs_out );
+
+        memcpy( ws.F[i], ws.rhs_out + N2, sizeof( ws.F[0] ) );
       }
     }
 
-    //  params are specified only to match the signature of other computeBN functions.
-    /// \param h  The distance between adjacent ts (e.g. t1-t0)
-    void computeB0( [[maybe_unused]] double t0, [[maybe_unused]] double h ) const
+    /// \brief The initial approximation of a step without a history: constant second derivative F[0]
+    void initial_approximation_of_F( Workspace& ws, double t0, double h ) const
     {
+      this->call_rhs( t0, ws.state, ws.rhs_out );
+      memcpy( ws.F[0], ws.rhs_out + N2, sizeof( ws.F[0] ) );
+
       for ( int index = 0; index < N2; index++ )
       {
-        B[0][index] = F[0][index];
+        ws.B[0][index] = ws.F[0][index];
+        for ( int j = 1; j <= k; j++ )
+        {
+          ws.B[j][index] = 0;
+        }
       }
+
+      compute_F( ws, t0, h );
     }
 
-    /// \param h  The distance between adjacent ts (e.g. t1-t0)
-    void computeB1( [[maybe_unused]] double t0, double h ) const
+    /// \brief Predicts B for the step starting at the end of the last step
+    /// \details The last polynomial F(s) is re-expanded around s = 1 and rescaled to the new step
+    void predict_Bs( Workspace& ws, double h ) const
     {
+      double ratio = h / m_history.last_h;
+
       for ( int index = 0; index < N2; index++ )
       {
-        double b1 = 0;
-        for ( int i = 1; i <= 5; i++ )
+        double ratio_power = 1;
+        for ( int m = 0; m <= k; m++ )
         {
-          double prod = 1;
-          for ( int j = 1; j <= i - 1; j++ )
+          // B_m = ratio ^ m * sum of C(j, m) * last_B_j over j = m...k
+          double b        = 0;
+          double binomial = 1;
+          for ( int j = m; j <= k; j++ )
           {
-            prod *= ( -h * j ); // t_0 - t_j = -h * j
+            b += binomial * m_history.last_B[j][index];
+            binomial = binomial * ( j + 1 ) / ( j + 1 - m );
           }
-          b1 += DD[0][i][index] * prod;
+          ws.B[m][index] = b * ratio_power;
+          ratio_power *= ratio;
         }
-        B[1][index] = b1;
       }
     }
 
-    /// \param h  The distance between adjacent ts (e.g. t1-t0)
-    void computeB2( double t0, double h ) const
+    /// \brief Computes DD (the coefficients of the Newton form of F(s)).
+    // F[i] must be computed before (using 'initial_approximation_of_F' or 'compute_F')
+    void compute_DD( Workspace& ws ) const
     {
-      const double t  = t0;
-      const double t1 = t0 + h;
-      const double t2 = t0 + 2 * h;
-      const double t3 = t0 + 3 * h;
-      const double t4 = t0 + 4 * h;
+      memcpy( ws.DD, ws.F, sizeof( ws.DD ) );
 
-      const double F3_coef = ( 2 * t - t1 - t2 );
-      const double F4_coef = ( 3 * t * t - 2 * t * ( t1 + t2 + t3 ) + t1 * ( t2 + t3 ) + t2 * t3 );
-      const double F5_coef = ( t1 * ( t2 * ( 2.0 * t - t3 - t4 ) + t * ( -3.0 * t + 2.0 * t3 + 2.0 * t4 ) - t3 * t4 ) + t2 * ( t * ( -3.0 * t + 2.0 * t3 + 2.0 * t4 ) - t3 * t4 ) + t * ( t * ( 4.0 * t - 3.0 * t3 - 3.0 * t4 ) + 2.0 * t3 * t4 ) );
-
-      for ( int index = 0; index < N2; index++ )
+      for ( int order = 1; order <= k; order++ )
       {
-        // the following formula was derivided manually and revised in 2 weeks with a help of Wolfram Alpha
-        B[2][index] = DD[0][2][index] + DD[0][3][index] * F3_coef + DD[0][4][index] * F4_coef + DD[0][5][index] * F5_coef;
+        for ( int i = k; i >= order; i-- )
+        {
+          double denominator = spacings[i] - spacings[i - order];
+          for ( int index = 0; index < N2; index++ )
+          {
+            ws.DD[i][index] = ( ws.DD[i][index] - ws.DD[i - 1][index] ) / denominator;
+          }
+        }
       }
     }
 
-    /// \param h  The distance between adjacent ts (e.g. t1-t0)
-    void computeB3( double t0, double h ) const
+    /// \brief Compute all the B_j (as the Newton form expanded in powers of s)
+    void computeBs( Workspace& ws ) const
     {
-      const double t  = t0;
-      const double t1 = t0 + h;
-      const double t2 = t0 + 2 * h;
-      const double t3 = t0 + 3 * h;
-      const double t4 = t0 + 4 * h;
-
-      const double F4_coef = ( 3 * t - ( t1 + t2 + t3 ) );
-      const double F5_coef = ( 6 * t * t - 3 * t * ( t1 + t2 + t3 + t4 ) + ( t1 * ( t2 + t3 + t4 ) + t2 * ( t3 + t4 ) + t3 * t4 ) );
-
-      for ( int index = 0; index < N2; index++ )
+      for ( int j = 0; j <= k; j++ )
       {
-        B[3][index] = DD[0][3][index] + DD[0][4][index] * F4_coef + DD[0][5][index] * F5_coef;
+        for ( int index = 0; index < N2; index++ )
+        {
+          double b = 0;
+          for ( int m = j; m <= k; m++ )
+          {
+            b += ws.DD[m][index] * newton_coeff[m][j];
+          }
+          ws.B[j][index] = b;
+        }
       }
     }
 
-    /// \param h  The distance between adjacent ts (e.g. t1-t0)
-    void computeB4( double t0, double h ) const
+    /// \brief Forgets the last step (the next step starts without the predictor)
+    void reset() const override
     {
-      const double t  = t0;
-      const double t1 = t0 + h;
-      const double t2 = t0 + 2 * h;
-      const double t3 = t0 + 3 * h;
-      const double t4 = t0 + 4 * h;
-
-      const double F5_coef = ( 4 * t - ( t1 + t2 + t3 + t4 ) );
-
-      for ( int index = 0; index < N2; index++ )
-      {
-        B[4][index] = DD[0][4][index] + DD[0][5][index] * F5_coef;
-      }
+      m_history.has_last_step = false;
     }
 
-    /// \param h  The distance between adjacent ts (e.g. t1-t0)
-    void computeB5( [[maybe_unused]] double t0, [[maybe_unused]] double h ) const
+    void save( StepperSnapshot& snapshot ) const override
     {
-      for ( int index = 0; index < N2; index++ )
-      {
-        B[5][index] = DD[0][5][index];
-      }
+      snapshot.put( m_history );
     }
 
-    /// \brief Compute all the B_j
-    /// \param h  The distance between adjacent ts (e.g. t1-t0)
-    void computeBs( double t0, double h ) const
+    void load( StepperSnapshot& snapshot ) const override
     {
-      computeB0( t0, h );
-      computeB1( t0, h );
-      computeB2( t0, h );
-      computeB3( t0, h );
-      computeB4( t0, h );
-      computeB5( t0, h );
+      snapshot.get( m_history );
     }
 
     /// \brief The stepper function
     /// \param current_time The current time
     /// \param current_state The current state of the system
     /// \param next_state The next state of the system
-    /// \return The next time (current_time + dt) and the delta time
+    /// \return The next time (current_time + dt) and the suggested next delta time
 
     std::pair<double, double>
     operator()( double current_state[RHS::N], double next_state[RHS::N], double current_time, double suggested_d_time = 0.01 ) const override
     {
-      double dist_between_adjacent_ts = suggested_d_time / k;
+      Workspace ws;
 
-      memcpy( y[0], current_state, sizeof( current_state[0] ) * N2 );
-      memcpy( dy_dt[0], current_state + N2, sizeof( current_state[0] ) * N2 );
+      double h = suggested_d_time;
+
+      if ( std::abs( h ) <= 4.0 * CONST::EPS<double> * std::max( std::abs( current_time ), std::abs( current_time + h ) ) )
+      {
+        throw std::runtime_error( "Everhart_TimeStepper: The step size underflowed at t = " + std::to_string( current_time ) );
+      }
+
+      memcpy( ws.y[0], current_state, sizeof( ws.y[0] ) );
+      memcpy( ws.dy_dt[0], current_state + N2, sizeof( ws.dy_dt[0] ) );
+      memcpy( ws.state, current_state, sizeof( ws.state ) );
+
+      // The previous step can be used as the predictor only if the trajectory is continued
+      bool continued = m_history.has_last_step &&
+                       current_time == m_history.last_t0 + m_history.last_h &&
+                       memcmp( current_state, m_history.last_state, sizeof( m_history.last_state ) ) == 0;
 
       // Step 1: INITIAL APPROXIMATION
-      initial_approximation_of_F( current_time, dist_between_adjacent_ts );
+      if ( continued )
+      {
+        // extrapolation of the last step's polynomial, F[0] was computed at the end of the last step
+        memcpy( ws.F[0], m_history.last_F_end, sizeof( ws.F[0] ) );
+        predict_Bs( ws, h );
+        compute_F( ws, current_time, h );
+      }
+      else
+      {
+        initial_approximation_of_F( ws, current_time, h );
+      }
+
+      const int max_number_of_iterations = 12;
 
-      const int number_of_iterations = 10; // it should be improved later by observing convergence (if almost nothing has changed, then finish the step)
+      double norm_F = 0;
+      for ( int i = 0; i <= k; i++ )
+      {
+        for ( int index = 0; index < N2; index++ )
+        {
+          norm_F = std::max( norm_F, std::abs( ws.F[i][index] ) );
+        }
+      }
 
-      // Step 2: complete N iterations
-      for ( int j = 1; j <= number_of_iterations; j++ )
+      // Step 2: iterate until the highest B-term converges
+      for ( int j = 1; j <= max_number_of_iterations; j++ )
       {
+        double old_B_k[N2];
+        memcpy( old_B_k, ws.B[k], sizeof( old_B_k ) );
+        ++this->m_iterations;
+
         // Step 3: compute all divided differences (to order k)
-        compute_DD( dist_between_adjacent_ts );
+        compute_DD( ws );
 
         // Step 4: find B_j (as functions of divided differences)
-        computeBs( current_time, dist_between_adjacent_ts );
-
-        // Step 5: compute more accurate y(t), d[y(t)]/dt and F[i]
-        double eps = compute_F( current_time, dist_between_adjacent_ts );
+        computeBs( ws );
 
-        if ( eps < CONST::EPS<double> )
+        double change = 0;
+        for ( int index = 0; index < N2; index++ )
+        {
+          change = std::max( change, std::abs( ws.B[k][index] - old_B_k[index] ) );
+        }
+        if ( change <= CONST::EPS<double> * norm_F )
         {
           break;
         }
+
+        // Step 5: compute more accurate y(t), d[y(t)]/dt and F[i]
+        compute_F( ws, current_time, h );
+      }
+
+      // Step 6: the next step size from the size of the highest term (B_k against atol + tolerance * |F|), B_k below
+      // the roundoff is noise and doesn't shrink the step
+      double norm_B = 0;
+      for ( int index = 0; index < N2; index++ )
+      {
+        norm_B = std::max( norm_B, std::abs( ws.B[k][index] ) );
       }
+      norm_B = std::max( norm_B, m_roundoff * norm_F );
 
-      memcpy( next_state, y[k], sizeof( current_state[0] ) * N2 );
-      memcpy( next_state + N2, dy_dt[k], sizeof( current_state[0] ) * N2 );
+      double scale  = m_atol + m_tolerance * norm_F;
+      double factor = norm_B > 0 ? std::pow( scale / norm_B, 1.0 / k ) : max_step_growth;
+      factor        = std::min( factor, max_step_growth );
 
-      return { current_time + suggested_d_time, suggested_d_time };
+      if ( factor < min_step_decrease )
+      {
+        ++this->m_rejections;
+        return ( *this )( current_state, next_state, current_time, factor * h );
+      }
+
+      compute_state( ws, k + 1, h, next_state, next_state + N2 );
+
+      this->call_rhs( current_time + h, next_state, ws.rhs_out );
+
+      m_history.has_last_step = true;
+      m_history.last_t0       = current_time;
+      m_history.last_h        = h;
+      memcpy( m_history.last_B, ws.B, sizeof( m_history.last_B ) );
+      memcpy( m_history.last_y0, current_state, sizeof( m_history.last_y0 ) );
+      memcpy( m_history.last_F_end, ws.rhs_out + N2, sizeof( m_history.last_F_end ) );
+      memcpy( m_history.last_state, next_state, sizeof( m_history.last_state ) );
+
+      return { current_time + h, factor * h };
+    }
+
+    /// \brief Evaluates (*) and (**) from 'compute_state' at an arbitrary point of the last step
+    void dense_output( double t, double state_out[RHS::N] ) const override
+    {
+      const History& last = m_history;
+
+      double s = ( t - last.last_t0 ) / last.last_h;
+
+      for ( int equation = 0; equation < N2; equation++ )
+      {
+        double dy = 0;
+        double yy = 0;
+        for ( int j = k; j >= 0; j-- )
+        {
+          dy = ( dy + last.last_B[j][equation] / ( j + 1 ) ) * s;
+          yy = ( yy + last.last_B[j][equation] / ( ( j + 1 ) * ( j + 2 ) ) ) * s;
+        }
+
+        double y0  = last.last_y0[equation];
+        double dy0 = last.last_y0[equation + N2];
+
+        state_out[equation]      = y0 + last.last_h * ( dy0 * s + last.last_h * yy * s );
+        state_out[equation + N2] = dy0 + last.last_h * dy;
+      }
     }
   };
 } // namespace ADAAI::Integration::Integrator::Stepper
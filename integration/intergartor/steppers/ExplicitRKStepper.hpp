@@ -0,0 +1,217 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#include "BasicTimeStepper.hpp"
+#include "ButcherTableau.hpp"
+#include "DenseOutput.hpp"
+
+namespace ADAAI::Integration::Integrator::Stepper
+{
+  /// \brief The explicit Runge-Kutta method of a Butcher tableau known at compile time
+  /// \details The stages and the sums over them are unrolled, the terms with zero coefficients are dropped at
+  ///          compile time. The tableaus with an embedded solution adapt the step to the local error, the others
+  ///          take the suggested step. The first stage is taken from the last step when the step continues it
+  ///          (the last stage of the FSAL methods, the derivative of the dense output of the others).
+  /// \tparam Tableau The method (e.g. RK4, Fehlberg45, DormandPrince54, Tsitouras54, Verner65, PrinceDormand87)
+  template<typename RHS, const auto& Tableau>
+  class ExplicitRK_TimeStepper : public TimeStepper<RHS>
+  {
+    constexpr static int  S     = Tableau.stages;
+    constexpr static bool FSAL  = Tableau.fsal();
+    constexpr static bool Error = Tableau.embedded_order > 0;
+
+    /// \brief The weights of the local error estimate (b - b_hat)
+    constexpr static auto s_error = []
+    {
+      std::array<double, S> error {};
+      for ( int i = 0; i < S; ++i )
+      {
+        error[i] = Tableau.b[i] - Tableau.b_hat[i];
+      }
+      return error;
+    }();
+
+    /// \brief The indices j < Count of the non-zero Coefficients[j]
+    template<std::array<double, S> Coefficients, int Count>
+    constexpr static auto NonZero()
+    {
+      struct Indices
+      {
+        std::size_t index[S + 1] {};
+        std::size_t size = 0;
+      };
+
+      constexpr Indices found = []
+      {
+        Indices indices;
+        for ( int j = 0; j < Count; ++j )
+        {
+          if ( Coefficients[j] != 0.0 )
+          {
+            indices.index[indices.size++] = j;
+          }
+        }
+        return indices;
+      }();
+
+      return []<std::size_t... I>( std::index_sequence<I...> )
+      {
+        return std::index_sequence<found.index[I]...>();
+      }( std::make_index_sequence<found.size>() );
+    }
+
+    /// \brief out = y + h * sum Coefficients[j] * k_j over the non-zero coefficients (y == nullptr: without y)
+    template<std::array<double, S> Coefficients, std::size_t... J>
+    static void combine( const double* y, double h, const double* ks, int n, double* out, std::index_sequence<J...> )
+    {
+      for ( int i = 0; i < n; ++i )
+      {
+        if constexpr ( sizeof...( J ) == 0 )
+        {
+          out[i] = y == nullptr ? 0.0 : y[i];
+        }
+        else
+        {
+          double sum = ( ( Coefficients[J] * ks[J * n + i] ) + ... );
+          out[i]     = y == nullptr ? h * sum : y[i] + h * sum;
+        }
+      }
+    }
+
+    template<std::array<double, S> Coefficients, int Count>
+    static void combine( const double* y, double h, const double* ks, int n, double* out )
+    {
+      combine<Coefficients>( y, h, ks, n, out, NonZero<Coefficients, Count>() );
+    }
+
+    /// \brief k_I = f(t + c_I h, y + h sum_{j<I} a_Ij k_j) for the stages I = 1...S-1
+    template<std::size_t... I>
+    void stages( const double* y, double t, double h, double* ks, double* stage, int n, std::index_sequence<I...> ) const
+    {
+      ( ( combine<Tableau.a[I + 1], I + 1>( y, h, ks, n, stage ), this->call_rhs( t + Tableau.c[I + 1] * h, stage, ks + ( I + 1 ) * n ) ), ... );
+    }
+
+    double m_atol;
+    double m_rtol;
+
+    // The last step data (for dense output and the first stage of the next step)
+    mutable double               m_t0 = 0.0;
+    mutable double               m_h  = 0.0;
+    mutable double               m_t1 = 0.0;
+    mutable StateStorage<RHS::N> m_y0;
+    mutable StateStorage<RHS::N> m_f0;
+    mutable StateStorage<RHS::N> m_y1;
+    mutable StateStorage<RHS::N> m_f1;
+    mutable bool                 m_f1_ready = false; // f(t1, y1) is known (the last stage of FSAL, else the first dense_output call)
+
+  public:
+    /// \param atol, rtol The absolute and relative tolerances of the local error (unused without an embedded solution)
+    explicit ExplicitRK_TimeStepper( const RHS* rhs, double atol = 1e-10, double rtol = 1e-10 )
+        : TimeStepper<RHS>( rhs ), m_atol( atol ), m_rtol( rtol ),
+          m_y0( StateSize( *rhs ) ), m_f0( StateSize( *rhs ) ), m_y1( StateSize( *rhs ) ), m_f1( StateSize( *rhs ) )
+    {
+    }
+
+    /// \brief The stepper function
+    /// \param current_time The current time
+    /// \param current_state The current state of the system
+    /// \param next_state The next state of the system
+    /// \return The next time (current_time + dt) and the suggested next dt
+    std::pair<double, double>
+    operator()( double current_state[], double next_state[], double current_time, double suggested_d_time = 0.01 ) const override
+    {
+      const int n = this->size();
+
+      ArenaFrame            frame( this->arena() );
+      StateArray<RHS::N, S> ks( this->arena(), n ); // k_i starts at i * n
+      StateArray<RHS::N>    stage( this->arena(), n );
+      double                h = suggested_d_time;
+
+      if ( m_f1_ready && current_time == m_t1 && std::memcmp( current_state, m_y1, n * sizeof( double ) ) == 0 )
+      {
+        std::memcpy( ks, m_f1, n * sizeof( double ) );
+      }
+      else
+      {
+        this->call_rhs( current_time, current_state, ks );
+      }
+
+      double next_h = h;
+      while ( true )
+      {
+        stages( current_state, current_time, h, ks, stage, n, std::make_index_sequence<S - 1>() );
+
+        if constexpr ( FSAL )
+        {
+          std::memcpy( next_state, stage, n * sizeof( double ) ); // The last stage is evaluated at y_1
+        }
+        else
+        {
+          combine<Tableau.b, S>( current_state, h, ks, n, next_state );
+        }
+
+        if constexpr ( !Error )
+        {
+          break;
+        }
+        else
+        {
+          combine<s_error, S>( nullptr, h, ks, n, stage );
+
+          double norm = 0.0;
+          for ( int i = 0; i < n; ++i )
+          {
+            double scale = m_atol + m_rtol * std::max( std::abs( current_state[i] ), std::abs( next_state[i] ) );
+            norm += ( stage[i] / scale ) * ( stage[i] / scale );
+          }
+          norm = std::sqrt( norm / n );
+
+          constexpr double exponent = -1.0 / ( std::min( Tableau.order, Tableau.embedded_order ) + 1 );
+          double           factor   = norm > 0.0 ? 0.9 * std::pow( norm, exponent ) : 5.0;
+          next_h                    = h * std::clamp( factor, 0.2, 5.0 );
+
+          if ( norm <= 1.0 )
+          {
+            break;
+          }
+          ++this->m_rejections;
+          h = next_h;
+        }
+      }
+
+      m_t0       = current_time;
+      m_h        = h;
+      m_t1       = current_time + h;
+      m_f1_ready = FSAL;
+      std::memcpy( m_y0, current_state, n * sizeof( double ) );
+      std::memcpy( m_f0, ks, n * sizeof( double ) );
+      std::memcpy( m_y1, next_state, n * sizeof( double ) );
+      if constexpr ( FSAL )
+      {
+        std::memcpy( m_f1, ks + ( S - 1 ) * n, n * sizeof( double ) );
+      }
+
+      return { m_t1, next_h };
+    }
+
+    void reset() const override
+    {
+      m_f1_ready = false;
+    }
+
+    void dense_output( double t, double state[] ) const override
+    {
+      if ( !m_f1_ready )
+      {
+        this->call_rhs( m_t1, m_y1, m_f1 );
+        m_f1_ready = true;
+      }
+
+      HermiteInterpolation( ( t - m_t0 ) / m_h, m_h, m_y0, m_f0, m_y1, m_f1, state, this->size() );
+    }
+  }; // class ExplicitRK_TimeStepper
+} // namespace ADAAI::Integration::Integrator::Stepper
@@ -0,0 +1,436 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+#include <utility>
+#include <vector>
+
+#include "../Jacobian.hpp"
+#include "../linalg/BandMatrix.hpp"
+#include "../linalg/MatrixExponential.hpp"
+#include "BasicTimeStepper.hpp"
+
+namespace ADAAI::Integration::Integrator::Stepper
+{
+  /// \brief The exponential integrator for the linear RHS f(t, y) = A y + g(t) with piecewise constant A
+  /// \details On a step A is taken at the middle of the step and g(t0 + x h) is interpolated by the polynomial
+  ///          of degree Degree - 1 in x at the Chebyshev nodes. The polynomial is the solution of a nilpotent
+  ///          linear system, so the step is the action of the exponential of the augmented matrix
+  ///              Â = | A  G |, where G [eta] = sum of d_k eta_k and eta_k = x^k (d eta_k / dt = k / h * eta_(k - 1)),
+  ///                  | 0  S |
+  ///          on (y0, 1, 0, ..., 0). The action is computed with the shift-and-invert Krylov subspaces of
+  ///          Z = (I - gamma Â)^(-1) (J. van den Eshof, M. Hochbruck, SIAM J. Sci. Comput. 27, 2006), which converge
+  ///          independently of the stiffness of A: Z costs a banded LU decomposition of I - gamma A and the exponential
+  ///          of the small matrix (I - H^(-1)) / gamma uses the Pade approximation of the exp module. The Krylov
+  ///          substeps are controlled by the difference of the approximations in m and m - 1 Krylov vectors.
+  ///          The step stops at the breakpoints of the RHS (see BreakpointRHS), so it is exact (up to the
+  ///          tolerance) for the RHS that is constant between them, whatever the step.
+  /// \tparam KrylovDim The dimension of the Krylov subspaces
+  /// \tparam Degree The number of the interpolation nodes of g
+  template<typename RHS, int KrylovDim = 30, int Degree = 6>
+  class Exponential_TimeStepper : public TimeStepper<RHS>
+  {
+    static_assert( KrylovDim >= 2 && Degree >= 1, "Exponential_TimeStepper: Invalid Krylov dimension or degree" );
+
+    constexpr static int M  = KrylovDim;
+    constexpr static int NA = RHS::N + Degree; // The size of the augmented system
+
+    constexpr static double shift_ratio = 0.1;  // gamma = shift_ratio * (the Krylov substep)
+    constexpr static double min_substep = 1e-6; // The smallest Krylov substep (relative to the step)
+
+    double m_tolerance;
+
+    mutable Linalg::BandMatrix  m_jacobian;      // A
+    mutable Linalg::BandMatrix  m_shifted;       // I - gamma A (decomposed)
+    mutable std::vector<double> m_inhomogeneity; // d_k (Degree rows of N)
+    mutable std::vector<double> m_basis;         // The Arnoldi vectors (M + 1 rows of NA)
+    mutable std::vector<double> m_hessenberg;    // H (M x M)
+    mutable std::vector<double> m_generator;     // dt (I - H^(-1)) / gamma (M x M)
+    mutable std::vector<double> m_exponential;   // exp(dt (I - H^(-1)) / gamma) (M x M)
+
+    mutable double m_gamma        = 0.0; // The shift of m_shifted
+    mutable double m_tau          = 0.0; // The last Krylov substep (relative to the step)
+    mutable long   m_krylov_steps = 0;   // The number of the Krylov substeps (Arnoldi processes) so far
+
+    // The last step data (for dense output)
+    mutable double m_t0 = 0.0;
+    mutable double m_h  = 0.0;
+    mutable double m_y0[RHS::N] {};
+
+    /// \brief Computes Â w
+    void multiply( const double* w, double* result ) const
+    {
+      m_jacobian.multiply( w, result );
+
+      const double* eta = w + RHS::N;
+      for ( int k = 0; k < Degree; ++k )
+      {
+        const double* d = m_inhomogeneity.data() + static_cast<std::size_t>( k ) * RHS::N;
+        for ( int i = 0; i < RHS::N; ++i )
+        {
+          result[i] += d[i] * eta[k];
+        }
+      }
+
+      result[RHS::N] = 0.0;
+      for ( int k = 1; k < Degree; ++k )
+      {
+        result[RHS::N + k] = k / m_h * eta[k - 1];
+      }
+    }
+
+    /// \brief Computes (I - gamma Â)^(-1) w (S is nilpotent, so eta is the forward substitution, then y is the banded solve)
+    void solve_shifted( const double* w, double* result ) const
+    {
+      const double* eta_in = w + RHS::N;
+      double*       eta    = result + RHS::N;
+
+      eta[0] = eta_in[0];
+      for ( int k = 1; k < Degree; ++k )
+      {
+        eta[k] = eta_in[k] + m_gamma * k / m_h * eta[k - 1];
+      }
+
+      for ( int i = 0; i < RHS::N; ++i )
+      {
+        result[i] = w[i];
+      }
+      for ( int k = 0; k < Degree; ++k )
+      {
+        const double* d = m_inhomogeneity.data() + static_cast<std::size_t>( k ) * RHS::N;
+        for ( int i = 0; i < RHS::N; ++i )
+        {
+          result[i] += m_gamma * d[i] * eta[k];
+        }
+      }
+      m_shifted.solve( result );
+    }
+
+    /// \brief Decomposes I - gamma A
+    void factorize_shifted( double gamma ) const
+    {
+      const int ml = m_jacobian.lower();
+      const int mu = m_jacobian.upper();
+
+      m_shifted.setZero();
+      for ( int i = 0; i < RHS::N; ++i )
+      {
+        for ( int j = std::max( 0, i - ml ); j <= std::min( RHS::N - 1, i + mu ); ++j )
+        {
+          m_shifted( i, j ) = -gamma * m_jacobian( i, j );
+        }
+        m_shifted( i, i ) += 1.0;
+      }
+      m_shifted.factorize();
+      m_gamma = gamma;
+    }
+
+    /// \brief Fits the polynomial of the inhomogeneity g(t) = f(t, 0) on [t0, t0 + h]
+    void fit_inhomogeneity( double t0, double h ) const
+    {
+      double zero[RHS::N] {};
+      double g[RHS::N];
+      double nodes[Degree];
+
+      Linalg::BandMatrix vandermonde( Degree, Degree - 1, Degree - 1 );
+      for ( int q = 0; q < Degree; ++q )
+      {
+        nodes[q] = ( 1.0 - std::cos( std::numbers::pi * ( 2 * q + 1 ) / ( 2 * Degree ) ) ) / 2.0;
+
+        double power = 1.0;
+        for ( int k = 0; k < Degree; ++k )
+        {
+          vandermonde( q, k ) = power;
+          power *= nodes[q];
+        }
+      }
+      vandermonde.factorize();
+
+      std::vector<double> values( static_cast<std::size_t>( Degree ) * RHS::N );
+      for ( int q = 0; q < Degree; ++q )
+      {
+        this->call_rhs( t0 + nodes[q] * h, zero, g );
+        for ( int i = 0; i < RHS::N; ++i )
+        {
+          values[static_cast<std::size_t>( i ) * Degree + q] = g[i];
+        }
+      }
+
+      for ( int i = 0; i < RHS::N; ++i )
+      {
+        double* coefficients = values.data() + static_cast<std::size_t>( i ) * Degree;
+        vandermonde.solve( coefficients );
+        for ( int k = 0; k < Degree; ++k )
+        {
+          m_inhomogeneity[static_cast<std::size_t>( k ) * RHS::N + i] = coefficients[k];
+        }
+      }
+    }
+
+    /// \brief The first column of exp(dt (I - H_k^(-1)) / gamma) of the leading k x k block of the Hessenberg matrix
+    void small_exponential( int k, double dt, double gamma, double* column ) const
+    {
+      Linalg::BandMatrix hessenberg( k, k - 1, k - 1 );
+      for ( int i = 0; i < k; ++i )
+      {
+        for ( int j = 0; j < k; ++j )
+        {
+          hessenberg( i, j ) = m_hessenberg[i * M + j];
+        }
+      }
+      hessenberg.factorize();
+
+      for ( int j = 0; j < k; ++j )
+      {
+        std::fill( column, column + k, 0.0 );
+        column[j] = 1.0;
+        hessenberg.solve( column );
+        for ( int i = 0; i < k; ++i )
+        {
+          m_generator[i * k + j] = dt * ( ( i == j ? 1.0 : 0.0 ) - column[i] ) / gamma;
+        }
+      }
+      Linalg::MatrixExponential( m_generator.data(), k, m_exponential.data() );
+
+      for ( int i = 0; i < k; ++i )
+      {
+        column[i] = m_exponential[i * k];
+      }
+    }
+
+    /// \brief Replaces w with exp(x h Â) w
+    /// \param tau The first Krylov substep (relative to h), replaced with the suggestion for the next one
+    void propagate( double* w, double x, double& tau ) const
+    {
+      double done = 0.0;
+
+      while ( done < x )
+      {
+        tau = std::min( tau, x - done );
+
+        double beta = 0.0;
+        for ( int i = 0; i < NA; ++i )
+        {
+          beta += w[i] * w[i];
+        }
+        beta = std::sqrt( beta );
+        if ( beta == 0.0 )
+        {
+          return;
+        }
+
+        double gamma = shift_ratio * tau * m_h;
+        if ( gamma != m_gamma )
+        {
+          factorize_shifted( gamma );
+        }
+
+        // Arnoldi on Z (modified Gram-Schmidt, twice)
+        std::fill( m_hessenberg.begin(), m_hessenberg.end(), 0.0 );
+        for ( int i = 0; i < NA; ++i )
+        {
+          m_basis[i] = w[i] / beta;
+        }
+
+        int    m         = M;
+        double h_next    = 0.0;
+        bool   breakdown = false;
+        for ( int j = 0; j < M; ++j )
+        {
+          double* v = m_basis.data() + static_cast<std::size_t>( j + 1 ) * NA;
+          solve_shifted( m_basis.data() + static_cast<std::size_t>( j ) * NA, v );
+
+          double norm = 0.0;
+          for ( int i = 0; i < NA; ++i )
+          {
+            norm += v[i] * v[i];
+          }
+
+          // The second pass restores the orthogonality lost by the first one: on the substeps short compared to
+          // the time scale of A, Z is close to I and the new directions are small differences
+          for ( int pass = 0; pass < 2; ++pass )
+          {
+            for ( int l = 0; l <= j; ++l )
+            {
+              const double* u   = m_basis.data() + static_cast<std::size_t>( l ) * NA;
+              double        dot = 0.0;
+              for ( int i = 0; i < NA; ++i )
+              {
+                dot += u[i] * v[i];
+              }
+              m_hessenberg[l * M + j] += dot;
+              for ( int i = 0; i < NA; ++i )
+              {
+                v[i] -= dot * u[i];
+              }
+            }
+          }
+
+          h_next = 0.0;
+          for ( int i = 0; i < NA; ++i )
+          {
+            h_next += v[i] * v[i];
+          }
+          h_next = std::sqrt( h_next );
+
+          if ( h_next <= 1e-12 * std::sqrt( norm ) )
+          {
+            // The subspace is invariant, the approximation is exact
+            m         = j + 1;
+            breakdown = true;
+            break;
+          }
+
+          if ( j + 1 < M )
+          {
+            m_hessenberg[( j + 1 ) * M + j] = h_next;
+          }
+          for ( int i = 0; i < NA; ++i )
+          {
+            v[i] /= h_next;
+          }
+        }
+        ++m_krylov_steps;
+
+        // The difference of the approximations in m and m - 1 Krylov vectors estimates the error, it must be
+        // below tolerance * beta * (substep / step). The convergence depends on gamma / substep, so a rejected
+        // substep is halved with a new subspace
+        double approximation[M];
+        double lower_approximation[M];
+        small_exponential( m, tau * m_h, gamma, approximation );
+
+        double error = 0.0;
+        if ( !breakdown )
+        {
+          small_exponential( m - 1, tau * m_h, gamma, lower_approximation );
+          lower_approximation[m - 1] = 0.0;
+          for ( int k = 0; k < m; ++k )
+          {
+            error += ( approximation[k] - lower_approximation[k] ) * ( approximation[k] - lower_approximation[k] );
+          }
+          error = beta * std::sqrt( error );
+        }
+
+        if ( error > m_tolerance * beta * tau && tau > min_substep * x )
+        {
+          ++this->m_rejections;
+          tau *= 0.5;
+          continue;
+        }
+
+        // w = beta V exp(dt (I - H^(-1)) / gamma) e_1
+        std::fill( w, w + NA, 0.0 );
+        for ( int j = 0; j < m; ++j )
+        {
+          const double* v = m_basis.data() + static_cast<std::size_t>( j ) * NA;
+          double        c = beta * approximation[j];
+          for ( int i = 0; i < NA; ++i )
+          {
+            w[i] += c * v[i];
+          }
+        }
+
+        done += tau;
+        if ( error <= 0.1 * m_tolerance * beta * tau )
+        {
+          tau *= 2.0;
+        }
+      }
+    }
+
+    /// \brief The state at t0 + x h of the last step (the augmented vector (y0, 1) propagated by x)
+    void solve( double x, double& tau, double state[RHS::N] ) const
+    {
+      double w[NA] {};
+      std::memcpy( w, m_y0, sizeof( m_y0 ) );
+      w[RHS::N] = 1.0;
+
+      propagate( w, x, tau );
+
+      std::memcpy( state, w, sizeof( m_y0 ) );
+    }
+
+  public:
+    /// \param rhs The right-hand side of the system (affine in the state)
+    /// \param tolerance The local error of the Krylov approximation relative to the augmented state
+    explicit Exponential_TimeStepper( const RHS* rhs, double tolerance = 1e-10 )
+        : TimeStepper<RHS>( rhs ), m_tolerance( tolerance ),
+          m_jacobian( RHS::N, LowerBandwidth<RHS>(), UpperBandwidth<RHS>() ),
+          m_shifted( RHS::N, LowerBandwidth<RHS>(), UpperBandwidth<RHS>() ),
+          m_inhomogeneity( static_cast<std::size_t>( Degree ) * RHS::N ),
+          m_basis( static_cast<std::size_t>( M + 1 ) * NA ),
+          m_hessenberg( static_cast<std::size_t>( M ) * M ),
+          m_generator( static_cast<std::size_t>( M ) * M ),
+          m_exponential( static_cast<std::size_t>( M ) * M )
+    {
+    }
+
+    /// \brief The number of the Krylov substeps (each is an Arnoldi process and small exponentials) so far
+    [[nodiscard]] long krylovSteps() const
+    {
+      return m_krylov_steps;
+    }
+
+    void reset() const override
+    {
+      m_gamma = 0.0;
+      m_tau   = 0.0;
+    }
+
+    void save( StepperSnapshot& snapshot ) const override
+    {
+      snapshot.put( m_tau );
+    }
+
+    void load( StepperSnapshot& snapshot ) const override
+    {
+      snapshot.get( m_tau );
+    }
+
+    /// \brief The stepper function
+    /// \param current_time The current time
+    /// \param current_state The current state of the system
+    /// \param next_state The next state of the system
+    /// \param suggested_d_time The step (cut at the next breakpoint of the RHS)
+    /// \return The next time (current_time + dt) and the step to the next breakpoint (or the same step)
+
+    std::pair<double, double>
+    operator()( double current_state[RHS::N], double next_state[RHS::N], double current_time, double suggested_d_time = 1.0 ) const override
+    {
+      double h = std::min( suggested_d_time, NextBreakpoint<RHS>( current_time ) - current_time );
+
+      double f[RHS::N];
+      this->call_rhs( current_time + h / 2.0, current_state, f );
+      this->m_rhs_calls += ComputeJacobian( *this->m_rhs, current_time + h / 2.0, current_state, f, m_jacobian, this->arena() );
+
+      m_t0 = current_time;
+      m_h  = h;
+      std::memcpy( m_y0, current_state, sizeof( m_y0 ) );
+      fit_inhomogeneity( current_time, h );
+      m_gamma = 0.0; // A has changed
+
+      // The substep is adapted by the steps only, so the dense output doesn't change them
+      if ( m_tau <= 0.0 )
+      {
+        m_tau = 1.0;
+      }
+      solve( 1.0, m_tau, next_state );
+
+      double next_time = current_time + h;
+      double next_h    = NextBreakpoint<RHS>( next_time ) - next_time;
+
+      return { next_time, std::isfinite( next_h ) ? next_h : h };
+    }
+
+    /// \brief The exact (up to the tolerance) solution of the linear system of the last step
+    void dense_output( double t, double state[RHS::N] ) const override
+    {
+      double x   = ( t - m_t0 ) / m_h;
+      double tau = m_tau > 0.0 ? m_tau : x;
+
+      solve( x, tau, state );
+    }
+  }; // class Exponential_TimeStepper
+} // namespace ADAAI::Integration::Integrator::Stepper
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <gsl/gsl_errno.h>
+#include <gsl/gsl_odeiv2.h>
+
+#include "../../../utils/Consts.hpp"
+#include "BasicTimeStepper.hpp"
+#include "DenseOutput.hpp"
+
+namespace ADAAI::Integration::Integrator::Stepper
+{
+  enum class GSLMethod : int
+  {
+    RKF45, // Embedded Runge-Kutta-Fehlberg (4, 5)
+    RK8PD, // Embedded Runge-Kutta Prince-Dormand (8, 9)
+    MSBDF, // Variable-coefficient linear multistep backward differentiation formula (stiff problems)
+  };
+
+  /// \brief A reference stepper on top of gsl_odeiv2_driver
+  /// \details Each step integrates [t, t + dt] with GSL's own adaptive step control
+  template<typename RHS>
+  class GSLTimeStepper : public TimeStepper<RHS>
+  {
+    gsl_odeiv2_system  m_system {};
+    gsl_odeiv2_driver* m_driver = nullptr;
+
+    mutable std::exception_ptr m_rhs_exception; // An exception of the RHS can't be thrown through GSL
+
+    // The end of the last step (GSL keeps a step history that is valid only for a continuous trajectory)
+    mutable double m_last_time = std::numeric_limits<double>::quiet_NaN();
+    mutable double m_last_state[RHS::N] {};
+
+    // The last step data (for dense output)
+    mutable double m_t0 = 0.0;
+    mutable double m_h  = 0.0;
+    mutable double m_y0[RHS::N] {};
+    mutable double m_f0[RHS::N] {};
+    mutable double m_f1[RHS::N] {};
+    mutable bool   m_dense_ready = false; // f at the ends of the step are evaluated lazily by the first dense_output call
+
+    static const gsl_odeiv2_step_type* getStepType( GSLMethod method )
+    {
+      switch ( method )
+      {
+        case GSLMethod::RKF45:
+          return gsl_odeiv2_step_rkf45;
+        case GSLMethod::RK8PD:
+          return gsl_odeiv2_step_rk8pd;
+        case GSLMethod::MSBDF:
+          return gsl_odeiv2_step_msbdf;
+      }
+
+      throw std::invalid_argument( "GSLTimeStepper: Unknown method" );
+    }
+
+    /// \brief Bridges GSL's C callback to the RHS (params is the stepper itself)
+    static int rhsTrampoline( double t, const double y[], double f[], void* params )
+    {
+      auto* stepper = static_cast<const GSLTimeStepper*>( params );
+
+      try
+      {
+        stepper->call_rhs( t, y, f );
+      }
+      catch ( ... )
+      {
+        stepper->m_rhs_exception = std::current_exception();
+        return GSL_EBADFUNC;
+      }
+
+      return GSL_SUCCESS;
+    }
+
+    /// \brief Forward difference Jacobian (required by the implicit MSBDF method)
+    static int jacobianTrampoline( double t, const double y[], double* dfdy, double dfdt[], void* params )
+    {
+      double f0[RHS::N] {};
+      double f1[RHS::N] {};
+      double y1[RHS::N];
+
+      std::memcpy( y1, y, sizeof( y1 ) );
+
+      if ( rhsTrampoline( t, y, f0, params ) != GSL_SUCCESS )
+      {
+        return GSL_EBADFUNC;
+      }
+
+      const double sqrt_eps = std::sqrt( CONST::EPS<double> );
+
+      for ( int j = 0; j < RHS::N; ++j )
+      {
+        double delta = sqrt_eps * std::max( std::abs( y[j] ), 1.0 );
+        y1[j]        = y[j] + delta;
+
+        if ( rhsTrampoline( t, y1, f1, params ) != GSL_SUCCESS )
+        {
+          return GSL_EBADFUNC;
+        }
+
+        for ( int i = 0; i < RHS::N; ++i )
+        {
+          dfdy[i * RHS::N + j] = ( f1[i] - f0[i] ) / delta;
+        }
+
+        y1[j] = y[j];
+      }
+
+      double delta_t = sqrt_eps * std::max( std::abs( t ), 1.0 );
+      if ( rhsTrampoline( t + delta_t, y, f1, params ) != GSL_SUCCESS )
+      {
+        return GSL_EBADFUNC;
+      }
+
+      for ( int i = 0; i < RHS::N; ++i )
+      {
+        dfdt[i] = ( f1[i] - f0[i] ) / delta_t;
+      }
+
+      return GSL_SUCCESS;
+    }
+
+  public:
+    /// \param rhs The right-hand side of the system
+    /// \param method The GSL stepping method
+    /// \param eps_abs, eps_rel The absolute and relative tolerances of the GSL step control
+    /// \param h_start The initial internal step of GSL
+    explicit GSLTimeStepper( const RHS* rhs, GSLMethod method = GSLMethod::RKF45, double eps_abs = 1e-9, double eps_rel = 1e-9, double h_start = 1e-6 )
+        : TimeStepper<RHS>( rhs )
+    {
+      m_system = { rhsTrampoline, jacobianTrampoline, RHS::N, this };
+      m_driver = gsl_odeiv2_driver_alloc_y_new( &m_system, getStepType( method ), h_start, eps_abs, eps_rel );
+
+      if ( m_driver == nullptr )
+      {
+        throw std::runtime_error( "GSLTimeStepper: Failed to allocate the GSL driver" );
+      }
+    }
+
+    // The GSL system keeps the pointer to the stepper
+    GSLTimeStepper( const GSLTimeStepper& )            = delete;
+    GSLTimeStepper& operator=( const GSLTimeStepper& ) = delete;
+
+    ~GSLTimeStepper()
+    {
+      gsl_odeiv2_driver_free( m_driver );
+    }
+
+    /// \brief The next step resets the GSL driver
+    void reset() const override
+    {
+      m_last_time = std::numeric_limits<double>::quiet_NaN();
+    }
+
+    /// \brief The state of the GSL driver is opaque, it can't be checkpointed
+    void save( [[maybe_unused]] StepperSnapshot& snapshot ) const override
+    {
+      throw std::runtime_error( "GSLTimeStepper: The state of the GSL driver can't be saved" );
+    }
+
+    std::pair<double, double>
+    operator()( double current_state[RHS::N], double next_state[RHS::N], double current_time, double suggested_d_time = 1e-2 ) const override
+    {
+      if ( current_time != m_last_time || std::memcmp( current_state, m_last_state, sizeof( m_last_state ) ) != 0 )
+      {
+        gsl_odeiv2_driver_reset( m_driver );
+      }
+
+      std::memcpy( next_state, current_state, sizeof( m_last_state ) );
+      std::memcpy( m_y0, current_state, sizeof( m_y0 ) );
+
+      double time   = current_time;
+      int    status = gsl_odeiv2_driver_apply( m_driver, &time, current_time + suggested_d_time, next_state );
+
+      if ( m_rhs_exception )
+      {
+        m_last_time = std::numeric_limits<double>::quiet_NaN();
+        std::rethrow_exception( std::exchange( m_rhs_exception, nullptr ) );
+      }
+      if ( status != GSL_SUCCESS )
+      {
+        m_last_time = std::numeric_limits<double>::quiet_NaN();
+        throw std::runtime_error( "GSL integration failed with status " + std::to_string( status ) );
+      }
+
+      m_last_time = time;
+      std::memcpy( m_last_state, next_state, sizeof( m_last_state ) );
+
+      m_t0          = current_time;
+      m_h           = time - current_time;
+      m_dense_ready = false;
+
+      return { time, m_h };
+    }
+
+    void dense_output( double t, double state[RHS::N] ) const override
+    {
+      if ( !m_dense_ready )
+      {
+        this->call_rhs( m_t0, m_y0, m_f0 );
+        this->call_rhs( m_t0 + m_h, m_last_state, m_f1 );
+        m_dense_ready = true;
+      }
+
+      HermiteInterpolation( ( t - m_t0 ) / m_h, m_h, m_y0, m_f0, m_last_state, m_f1, state, RHS::N );
+    }
+  }; // class GSLTimeStepper
+} // namespace ADAAI::Integration::Integrator::Stepper
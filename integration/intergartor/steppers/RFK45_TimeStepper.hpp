@@ -1,19 +1,31 @@
 #pragma once
 
 #include <cstring>
-#include <valarray>
 #include <vector>
 
 #include "BasicTimeStepper.hpp"
+#include "DenseOutput.hpp"
 
 namespace ADAAI::Integration::Integrator::Stepper
 {
   template<typename RHS>
   class RFK45_TimeStepper : public TimeStepper<RHS>
   {
+    double m_tolerance; // The bound of the squared norm of the local error
+
+    // The last step data (for dense output)
+    mutable double               m_t0 = 0.0;
+    mutable double               m_h  = 0.0;
+    mutable StateStorage<RHS::N> m_y0;
+    mutable StateStorage<RHS::N> m_f0;
+    mutable StateStorage<RHS::N> m_y1;
+    mutable StateStorage<RHS::N> m_f1;
+    mutable bool                 m_f1_ready = false; // f(t0 + h, y1) is evaluated lazily by the first dense_output call
+
   public:
-    explicit RFK45_TimeStepper( const RHS* rhs )
-        : TimeStepper<RHS>( rhs )
+    /// \param tolerance The bound of the squared norm of the local error of a step
+    explicit RFK45_TimeStepper( const RHS* rhs, double tolerance = 1e-9 )
+        : TimeStepper<RHS>( rhs ), m_tolerance( tolerance ), m_y0( StateSize( *rhs ) ), m_f0( StateSize( *rhs ) ), m_y1( StateSize( *rhs ) ), m_f1( StateSize( *rhs ) )
     {
     }
 
@@ -42,13 +54,17 @@ namespace ADAAI::Integration::Integrator::Stepper
     /// \return The next time (current_time + dt) and the delta time
 
     std::pair<double, double>
-    operator()( double current_state[RHS::N], double next_state[RHS::N], double current_time, double suggested_d_time = 0.01 ) const override
+    operator()( double current_state[], double next_state[], double current_time, double suggested_d_time = 0.01 ) const override
     {
       // ======================================================================
       // utils
-      double buf[RHS::N];
-      double cur[RHS::N];
-      double h = suggested_d_time;
+      const int n = this->size();
+
+      ArenaFrame            frame( this->arena() );
+      StateArray<RHS::N>    buf( this->arena(), n );
+      StateArray<RHS::N>    cur( this->arena(), n );
+      StateArray<RHS::N, 6> ks( this->arena(), n ); // k_i starts at i * n
+      double                h = suggested_d_time;
 
       auto mul = []( double* data, double c, std::size_t size )
       {
@@ -68,53 +84,74 @@ namespace ADAAI::Integration::Integrator::Stepper
 
       // ======================================================================
       // find ks
-      std::vector<std::vector<double>> ks( 6, std::vector<double>( RHS::N ) );
-      for ( std::size_t i = 0; i < ks.size(); ++i )
+      for ( std::size_t i = 0; i < 6; ++i )
       {
-        std::memcpy( cur, current_state, RHS::N * sizeof( double ) );
+        std::memcpy( cur, current_state, n * sizeof( double ) );
         for ( std::size_t j = 0; j < i; ++j )
         {
-          std::memcpy( buf, ks[j].data(), RHS::N * sizeof( double ) );
-          mul( buf, B_K_L[i + 1][j + 1], RHS::N );
-          add( cur, buf, RHS::N );
+          std::memcpy( buf, ks + j * n, n * sizeof( double ) );
+          mul( buf, B_K_L[i + 1][j + 1], n );
+          add( cur, buf, n );
         }
-        ( *this->m_rhs )( current_time + A_K[i + 1] * h, cur, ks[i].data() );
-        mul( ks[i].data(), h, RHS::N );
+        this->call_rhs( current_time + A_K[i + 1] * h, cur, ks + i * n );
+        mul( ks + i * n, h, n );
       }
 
       // ======================================================================
       // find error
-      std::memset( cur, 0, RHS::N * sizeof( double ) );
-      for ( std::size_t i = 0; i < ks.size(); ++i )
+      std::memset( cur, 0, n * sizeof( double ) );
+      for ( std::size_t i = 0; i < 6; ++i )
       {
-        std::memcpy( buf, ks[i].data(), RHS::N * sizeof( double ) );
-        mul( buf, CT_K[i + 1], RHS::N );
-        add( cur, buf, RHS::N );
+        std::memcpy( buf, ks + i * n, n * sizeof( double ) );
+        mul( buf, CT_K[i + 1], n );
+        add( cur, buf, n );
       }
       double TE = 0;
-      for ( int i = 0; i < RHS::N; ++i )
+      for ( int i = 0; i < n; ++i )
       {
         TE += cur[i] * cur[i];
       }
-      double eps = 1e-9;
-      // what eps to choose?
+      double eps      = m_tolerance;
       double new_step = 0.9 * h * std::pow( eps / TE, 0.1 );
+      new_step        = std::min( new_step, 5.0 * h ); // TE may vanish
       if ( TE > eps )
       {
+        ++this->m_rejections;
         return ( *this )( current_state, next_state, current_time, new_step );
       }
 
       // ======================================================================
       // save res
-      std::memcpy( next_state, current_state, RHS::N * sizeof( double ) );
-      for ( std::size_t i = 0; i < ks.size(); ++i )
+      std::memcpy( next_state, current_state, n * sizeof( double ) );
+      for ( std::size_t i = 0; i < 6; ++i )
+      {
+        std::memcpy( buf, ks + i * n, n * sizeof( double ) );
+        mul( buf, CH_K[i + 1], n );
+        add( next_state, buf, n );
+      }
+
+      m_t0       = current_time;
+      m_h        = h;
+      m_f1_ready = false;
+      for ( int i = 0; i < n; ++i )
       {
-        std::memcpy( buf, ks[i].data(), RHS::N * sizeof( double ) );
-        mul( buf, CH_K[i + 1], RHS::N );
-        add( next_state, buf, RHS::N );
+        m_y0[i] = current_state[i];
+        m_f0[i] = ks[i] / h;
+        m_y1[i] = next_state[i];
       }
 
       return { current_time + h, new_step };
     }
+
+    void dense_output( double t, double state[] ) const override
+    {
+      if ( !m_f1_ready )
+      {
+        this->call_rhs( m_t0 + m_h, m_y1, m_f1 );
+        m_f1_ready = true;
+      }
+
+      HermiteInterpolation( ( t - m_t0 ) / m_h, m_h, m_y0, m_f0, m_y1, m_f1, state, this->size() );
+    }
   };
 } // namespace ADAAI::Integration::Integrator::Stepper
\ No newline at end of file
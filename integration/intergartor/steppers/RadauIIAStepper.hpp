@@ -0,0 +1,337 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "../../../utils/Consts.hpp"
+#include "../Jacobian.hpp"
+#include "../linalg/BandMatrix.hpp"
+#include "BasicTimeStepper.hpp"
+
+namespace ADAAI::Integration::Integrator::Stepper
+{
+  /// \brief The 3-stage Radau IIA method (implicit Runge-Kutta, order 5, L-stable) for stiff systems
+  /// \details The stage increments Z_s = Y_s - y0 solve Z = h * (A x I) F(Z) by the simplified Newton iterations
+  ///          with the matrix I - h * (A x J). The unknowns are interleaved (Z_1[i], Z_2[i], Z_3[i], Z_1[i + 1], ...),
+  ///          so the matrix of the banded RHS is a band matrix of the size 3N with the bandwidths 3 * ml + 2, 3 * mu + 2.
+  ///          The error estimate and the step control follow E. Hairer and G. Wanner's RADAU5.
+  template<typename RHS>
+  class RadauIIA_TimeStepper : public TimeStepper<RHS>
+  {
+    constexpr static int S = 3; // The number of stages
+
+    constexpr static double sqrt6 = 2.4494897427831780982;
+
+    constexpr static double c[S]    = { ( 4.0 - sqrt6 ) / 10.0, ( 4.0 + sqrt6 ) / 10.0, 1.0 };
+    constexpr static double A[S][S] = {
+        { ( 88.0 - 7.0 * sqrt6 ) / 360.0, ( 296.0 - 169.0 * sqrt6 ) / 1800.0, ( -2.0 + 3.0 * sqrt6 ) / 225.0 },
+        { ( 296.0 + 169.0 * sqrt6 ) / 1800.0, ( 88.0 + 7.0 * sqrt6 ) / 360.0, ( -2.0 - 3.0 * sqrt6 ) / 225.0 },
+        { ( 16.0 - sqrt6 ) / 36.0, ( 16.0 + sqrt6 ) / 36.0, 1.0 / 9.0 },
+    };
+
+    // The embedded error estimate: (I / (h * gamma0) - J) err = f(y0) + sum of d_s * Z_s / h,
+    // gamma0 is the real eigenvalue of A
+    constexpr static double d[S] = { -( 13.0 + 7.0 * sqrt6 ) / 3.0, ( -13.0 + 7.0 * sqrt6 ) / 3.0, -1.0 / 3.0 };
+
+    constexpr static int max_newton_iterations = 7;
+
+    constexpr static double max_step_growth   = 8.0;
+    constexpr static double max_step_decrease = 0.2;
+
+    int    m_n; // The number of equations
+    double m_atol;
+    double m_rtol;
+    double m_gamma0;
+    double m_newton_tolerance; // The Newton iterations stop at this fraction of the local error tolerance
+
+    mutable double m_newton_rate = 1.0; // The convergence rate of the last Newton iterations
+
+    // The scratch data (per instance, the matrices are too big for the stack)
+    mutable Linalg::BandMatrix  m_jacobian;
+    mutable Linalg::BandMatrix  m_newton_matrix; // I - h * (A x J), interleaved
+    mutable Linalg::BandMatrix  m_error_matrix;  // I / (h * gamma0) - J
+    mutable std::vector<double> m_Z;
+    mutable std::vector<double> m_dZ;
+    mutable std::vector<double> m_F;
+
+    // The last step data (for dense output with the collocation polynomial)
+    mutable double               m_t0 = 0.0;
+    mutable double               m_h  = 0.0;
+    mutable StateStorage<RHS::N> m_y0;
+    mutable std::vector<double>  m_last_Z;
+
+    static int interleaved( int i, int s )
+    {
+      return S * i + s;
+    }
+
+    double scale( const double* y, int i ) const
+    {
+      return m_atol + m_rtol * std::abs( y[i] );
+    }
+
+    /// \brief Builds and decomposes the matrices of the step h
+    void factorize( double h ) const
+    {
+      const int ml = m_jacobian.lower();
+      const int mu = m_jacobian.upper();
+
+      m_newton_matrix.setZero();
+      m_error_matrix.setZero();
+
+      for ( int i = 0; i < m_n; ++i )
+      {
+        for ( int j = std::max( 0, i - ml ); j <= std::min( m_n - 1, i + mu ); ++j )
+        {
+          double J_ij = m_jacobian( i, j );
+
+          m_error_matrix( i, j ) = -J_ij;
+          for ( int s = 0; s < S; ++s )
+          {
+            for ( int r = 0; r < S; ++r )
+            {
+              m_newton_matrix( interleaved( i, s ), interleaved( j, r ) ) = -h * A[s][r] * J_ij;
+            }
+          }
+        }
+
+        m_error_matrix( i, i ) += 1.0 / ( h * m_gamma0 );
+        for ( int s = 0; s < S; ++s )
+        {
+          m_newton_matrix( interleaved( i, s ), interleaved( i, s ) ) += 1.0;
+        }
+      }
+
+      m_newton_matrix.factorize();
+      m_error_matrix.factorize();
+    }
+
+    /// \brief Evaluates F_s = f(t0 + c_s * h, y0 + Z_s)
+    void evaluate_stages( double t0, double h, const double* y0 ) const
+    {
+      ArenaFrame         frame( this->arena() );
+      StateArray<RHS::N> stage_state( this->arena(), m_n );
+      StateArray<RHS::N> stage_rhs( this->arena(), m_n );
+
+      for ( int s = 0; s < S; ++s )
+      {
+        for ( int i = 0; i < m_n; ++i )
+        {
+          stage_state[i] = y0[i] + m_Z[interleaved( i, s )];
+        }
+
+        this->call_rhs( t0 + c[s] * h, stage_state, stage_rhs );
+
+        for ( int i = 0; i < m_n; ++i )
+        {
+          m_F[interleaved( i, s )] = stage_rhs[i];
+        }
+      }
+    }
+
+    /// \brief The simplified Newton iterations for Z
+    /// \return true if the iterations converged
+    bool solve_stages( double t0, double h, const double* y0 ) const
+    {
+      std::fill( m_Z.begin(), m_Z.end(), 0.0 );
+
+      double eta       = std::pow( std::max( m_newton_rate, CONST::EPS<double> ), 0.8 );
+      double prev_norm = 0.0;
+      double rate      = 0.0;
+      bool   has_rate  = false;
+
+      for ( int iteration = 0; iteration < max_newton_iterations; ++iteration )
+      {
+        ++this->m_iterations;
+        evaluate_stages( t0, h, y0 );
+
+        // dZ = -Z + h * (A x I) F
+        for ( int i = 0; i < m_n; ++i )
+        {
+          for ( int s = 0; s < S; ++s )
+          {
+            double sum = 0.0;
+            for ( int r = 0; r < S; ++r )
+            {
+              sum += A[s][r] * m_F[interleaved( i, r )];
+            }
+            m_dZ[interleaved( i, s )] = h * sum - m_Z[interleaved( i, s )];
+          }
+        }
+
+        m_newton_matrix.solve( m_dZ.data() );
+
+        double norm = 0.0;
+        for ( int i = 0; i < m_n; ++i )
+        {
+          for ( int s = 0; s < S; ++s )
+          {
+            double value = m_dZ[interleaved( i, s )] / scale( y0, i );
+            norm += value * value;
+          }
+        }
+        norm = std::sqrt( norm / ( S * m_n ) );
+
+        if ( iteration > 0 )
+        {
+          rate     = norm / prev_norm;
+          has_rate = true;
+          if ( rate >= 0.99 )
+          {
+            return false;
+          }
+          eta = rate / ( 1.0 - rate );
+        }
+        prev_norm = norm;
+
+        for ( std::size_t i = 0; i < m_Z.size(); ++i )
+        {
+          m_Z[i] += m_dZ[i];
+        }
+
+        if ( eta * norm <= m_newton_tolerance )
+        {
+          m_newton_rate = has_rate ? rate : m_newton_rate;
+          return true;
+        }
+      }
+
+      return false;
+    }
+
+  public:
+    /// \param rhs The right-hand side of the system
+    /// \param atol, rtol The absolute and relative tolerances of the local error
+    explicit RadauIIA_TimeStepper( const RHS* rhs, double atol = 1e-8, double rtol = 1e-6 )
+        : TimeStepper<RHS>( rhs ), m_n( StateSize( *rhs ) ), m_atol( atol ), m_rtol( rtol ),
+          m_jacobian( m_n, LowerBandwidth<RHS>( m_n ), UpperBandwidth<RHS>( m_n ) ),
+          m_newton_matrix( S * m_n,
+                           std::min( S * LowerBandwidth<RHS>( m_n ) + S - 1, S * m_n - 1 ),
+                           std::min( S * UpperBandwidth<RHS>( m_n ) + S - 1, S * m_n - 1 ) ),
+          m_error_matrix( m_n, LowerBandwidth<RHS>( m_n ), UpperBandwidth<RHS>( m_n ) ),
+          m_Z( S * m_n ), m_dZ( S * m_n ), m_F( S * m_n ), m_y0( m_n ), m_last_Z( S * m_n )
+    {
+      // The real eigenvalue of A
+      m_gamma0           = ( 6.0 + std::cbrt( 81.0 ) - std::cbrt( 9.0 ) ) / 30.0;
+      m_newton_tolerance = std::max( 10.0 * CONST::EPS<double> / m_rtol, std::min( 0.03, std::sqrt( m_rtol ) ) );
+    }
+
+    void reset() const override
+    {
+      m_newton_rate = 1.0;
+    }
+
+    void save( StepperSnapshot& snapshot ) const override
+    {
+      snapshot.put( m_newton_rate );
+    }
+
+    void load( StepperSnapshot& snapshot ) const override
+    {
+      snapshot.get( m_newton_rate );
+    }
+
+    /// \brief The stepper function
+    /// \param current_time The current time
+    /// \param current_state The current state of the system
+    /// \param next_state The next state of the system
+    /// \return The next time (current_time + dt) and the suggested next delta time
+
+    std::pair<double, double>
+    operator()( double current_state[], double next_state[], double current_time, double suggested_d_time = 1e-3 ) const override
+    {
+      double h = suggested_d_time;
+
+      ArenaFrame         frame( this->arena() );
+      StateArray<RHS::N> f0( this->arena(), m_n );
+      StateArray<RHS::N> error( this->arena(), m_n );
+
+      // J is computed once for all the attempts of the step
+      this->call_rhs( current_time, current_state, f0 );
+      this->m_rhs_calls += ComputeJacobian( *this->m_rhs, this->rhs_time( current_time ), current_state, f0, m_jacobian, this->arena() );
+
+      while ( true )
+      {
+        this->check_step( "RadauIIA_TimeStepper", current_time, h );
+        factorize( h );
+
+        if ( !solve_stages( current_time, h, current_state ) )
+        {
+          ++this->m_rejections;
+          m_newton_rate = 1.0;
+          h *= 0.5;
+          continue;
+        }
+
+        // The method is stiffly accurate: y1 = y0 + Z_3
+        for ( int i = 0; i < m_n; ++i )
+        {
+          next_state[i] = current_state[i] + m_Z[interleaved( i, S - 1 )];
+
+          double sum = 0.0;
+          for ( int s = 0; s < S; ++s )
+          {
+            sum += d[s] * m_Z[interleaved( i, s )];
+          }
+          error[i] = f0[i] + sum / h;
+        }
+        m_error_matrix.solve( error );
+
+        double err = 0.0;
+        for ( int i = 0; i < m_n; ++i )
+        {
+          double s = m_atol + m_rtol * std::max( std::abs( current_state[i] ), std::abs( next_state[i] ) );
+          err += ( error[i] / s ) * ( error[i] / s );
+        }
+        err = std::max( std::sqrt( err / m_n ), 1e-10 );
+
+        double factor = std::clamp( 0.9 * std::pow( err, -0.25 ), max_step_decrease, max_step_growth );
+
+        if ( err <= 1.0 )
+        {
+          m_t0 = current_time;
+          m_h  = h;
+          std::memcpy( m_y0, current_state, m_n * sizeof( double ) );
+          std::copy( m_Z.begin(), m_Z.end(), m_last_Z.begin() );
+
+          return { current_time + h, factor * h };
+        }
+
+        ++this->m_rejections;
+        h *= factor;
+      }
+    }
+
+    /// \brief The collocation polynomial of the last step (through y0 and the stage values)
+    void dense_output( double t, double state[] ) const override
+    {
+      double theta = ( t - m_t0 ) / m_h;
+
+      // The Lagrange basis on the nodes 0, c_1, c_2, c_3 (Z = 0 at the node 0)
+      double L[S];
+      for ( int s = 0; s < S; ++s )
+      {
+        L[s] = theta / c[s];
+        for ( int r = 0; r < S; ++r )
+        {
+          if ( r != s )
+          {
+            L[s] *= ( theta - c[r] ) / ( c[s] - c[r] );
+          }
+        }
+      }
+
+      for ( int i = 0; i < m_n; ++i )
+      {
+        state[i] = m_y0[i];
+        for ( int s = 0; s < S; ++s )
+        {
+          state[i] += L[s] * m_last_Z[interleaved( i, s )];
+        }
+      }
+    }
+  }; // class RadauIIA_TimeStepper
+} // namespace ADAAI::Integration::Integrator::Stepper
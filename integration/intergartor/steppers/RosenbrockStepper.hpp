@@ -0,0 +1,259 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "../Jacobian.hpp"
+#include "../linalg/BandMatrix.hpp"
+#include "BasicTimeStepper.hpp"
+#include "DenseOutput.hpp"
+
+namespace ADAAI::Integration::Integrator::Stepper
+{
+  /// \brief The linearly implicit Rosenbrock-W method ROS34PW2 for stiff systems
+  /// \details 4 stages, order 3 with the embedded order 2 solution for the step control, stiffly accurate
+  ///          and L-stable (J. Rang, L. Angermann, BIT 45, 2005). As a W-method it keeps its order with an
+  ///          approximate Jacobian. Each step costs one decomposition of (I / (h * gamma) - J), the Jacobian
+  ///          is banded if the RHS declares ML and MU (see Jacobian.hpp).
+  template<typename RHS>
+  class Rosenbrock_TimeStepper : public TimeStepper<RHS>
+  {
+    constexpr static int S = 4; // The number of stages
+
+    // The method: alpha_ij, gamma_ij, b_i and the embedded b^_i
+    constexpr static double gamma = 4.3586652150845900e-01;
+
+    constexpr static double Alpha[S][S] = {
+        { 0.0, 0.0, 0.0, 0.0 },
+        { 8.7173304301691801e-01, 0.0, 0.0, 0.0 },
+        { 8.4457060015369423e-01, -1.1299064236484185e-01, 0.0, 0.0 },
+        { 0.0, 0.0, 1.0, 0.0 },
+    };
+    constexpr static double Gamma[S][S] = {
+        { gamma, 0.0, 0.0, 0.0 },
+        { -8.7173304301691801e-01, gamma, 0.0, 0.0 },
+        { -9.0338057013044082e-01, 5.4180672388095326e-02, gamma, 0.0 },
+        { 2.4212380706095346e-01, -1.2232505839045147e+00, 5.4526025533510214e-01, gamma },
+    };
+    constexpr static double b[S]     = { 2.4212380706095346e-01, -1.2232505839045147e+00, 1.5452602553351020e+00, 4.3586652150845900e-01 };
+    constexpr static double b_hat[S] = { 3.7810903145819369e-01, -9.6042292212423178e-02, 0.5, 2.1793326075422950e-01 };
+
+    // The coefficients of the stages U_i = h * sum of gamma_ij * k_j (so the matrix-vector products are avoided):
+    // (I / (h * gamma) - J) U_i = f(t + alpha_i * h, y + sum of a_ij * U_j) + sum of c_ij / h * U_j + gamma_i * h * df/dt
+    double a[S][S] {};
+    double c[S][S] {};
+    double m[S] {};
+    double m_error[S] {}; // m - m^
+    double alpha_sum[S] {};
+    double gamma_sum[S] {};
+
+    double m_atol;
+    double m_rtol;
+
+    constexpr static double max_step_growth   = 5.0;
+    constexpr static double max_step_decrease = 0.2;
+
+    // The scratch data (per instance, the matrices are too big for the stack)
+    mutable Linalg::BandMatrix  m_jacobian;
+    mutable Linalg::BandMatrix  m_matrix;
+    mutable std::vector<double> m_stages; // U_1...U_S
+    mutable std::vector<double> m_dfdt;
+
+    // The last step data (for dense output)
+    mutable double m_t0 = 0.0;
+    mutable double m_h  = 0.0;
+    mutable double m_y0[RHS::N] {};
+    mutable double m_f0[RHS::N] {};
+    mutable double m_y1[RHS::N] {};
+    mutable double m_f1[RHS::N] {};
+    mutable bool   m_f1_ready = false; // f(t0 + h, y1) is evaluated lazily by the first dense_output call
+
+    /// \brief The weighted RMS norm of the error
+    double error_norm( const double* error, const double* y0, const double* y1 ) const
+    {
+      double sum = 0.0;
+      for ( int i = 0; i < RHS::N; ++i )
+      {
+        double scale = m_atol + m_rtol * std::max( std::abs( y0[i] ), std::abs( y1[i] ) );
+        sum += ( error[i] / scale ) * ( error[i] / scale );
+      }
+      return std::sqrt( sum / RHS::N );
+    }
+
+  public:
+    /// \param rhs The right-hand side of the system
+    /// \param atol, rtol The absolute and relative tolerances of the local error
+    explicit Rosenbrock_TimeStepper( const RHS* rhs, double atol = 1e-8, double rtol = 1e-6 )
+        : TimeStepper<RHS>( rhs ), m_atol( atol ), m_rtol( rtol ),
+          m_jacobian( RHS::N, LowerBandwidth<RHS>(), UpperBandwidth<RHS>() ),
+          m_matrix( RHS::N, LowerBandwidth<RHS>(), UpperBandwidth<RHS>() ),
+          m_stages( S * RHS::N ), m_dfdt( RHS::N )
+    {
+      // Gamma^-1 (lower triangular)
+      double gamma_inv[S][S] {};
+      for ( int i = 0; i < S; ++i )
+      {
+        gamma_inv[i][i] = 1.0 / Gamma[i][i];
+        for ( int j = 0; j < i; ++j )
+        {
+          double sum = 0.0;
+          for ( int l = j; l < i; ++l )
+          {
+            sum += Gamma[i][l] * gamma_inv[l][j];
+          }
+          gamma_inv[i][j] = -sum / Gamma[i][i];
+        }
+      }
+
+      // a = Alpha * Gamma^-1, c = diag(1 / gamma) - Gamma^-1, m = b * Gamma^-1
+      for ( int i = 0; i < S; ++i )
+      {
+        for ( int j = 0; j < i; ++j )
+        {
+          for ( int l = j; l < i; ++l )
+          {
+            a[i][j] += Alpha[i][l] * gamma_inv[l][j];
+          }
+          c[i][j] = -gamma_inv[i][j];
+        }
+
+        for ( int j = 0; j <= i; ++j )
+        {
+          alpha_sum[i] += Alpha[i][j];
+          gamma_sum[i] += Gamma[i][j];
+        }
+      }
+
+      for ( int j = 0; j < S; ++j )
+      {
+        double m_hat = 0.0;
+        for ( int i = j; i < S; ++i )
+        {
+          m[j] += b[i] * gamma_inv[i][j];
+          m_hat += b_hat[i] * gamma_inv[i][j];
+        }
+        m_error[j] = m[j] - m_hat;
+      }
+    }
+
+    /// \brief The stepper function
+    /// \param current_time The current time
+    /// \param current_state The current state of the system
+    /// \param next_state The next state of the system
+    /// \return The next time (current_time + dt) and the suggested next delta time
+
+    std::pair<double, double>
+    operator()( double current_state[RHS::N], double next_state[RHS::N], double current_time, double suggested_d_time = 1e-3 ) const override
+    {
+      double h = suggested_d_time;
+
+      double stage_state[RHS::N];
+      double stage_rhs[RHS::N];
+      double error[RHS::N];
+
+      // J and df/dt are computed once for all the attempts of the step
+      this->call_rhs( current_time, current_state, m_f0 );
+      this->m_rhs_calls += ComputeJacobian( *this->m_rhs, this->rhs_time( current_time ), current_state, m_f0, m_jacobian, this->arena() );
+      this->m_rhs_calls += ComputeTimeDerivative( *this->m_rhs, this->rhs_time( current_time ), current_state, m_f0, m_dfdt.data() );
+
+      while ( true )
+      {
+        this->check_step( "Rosenbrock_TimeStepper", current_time, h );
+
+        // M = I / (h * gamma) - J
+        m_matrix.setZero();
+        for ( int i = 0; i < RHS::N; ++i )
+        {
+          for ( int j = std::max( 0, i - m_matrix.lower() ); j <= std::min( RHS::N - 1, i + m_matrix.upper() ); ++j )
+          {
+            m_matrix( i, j ) = -m_jacobian( i, j );
+          }
+          m_matrix( i, i ) += 1.0 / ( h * gamma );
+        }
+        m_matrix.factorize();
+
+        for ( int s = 0; s < S; ++s )
+        {
+          double* U_s = m_stages.data() + s * RHS::N;
+
+          if ( s == 0 )
+          {
+            std::memcpy( stage_rhs, m_f0, sizeof( stage_rhs ) );
+          }
+          else
+          {
+            std::memcpy( stage_state, current_state, sizeof( stage_state ) );
+            for ( int j = 0; j < s; ++j )
+            {
+              const double* U_j = m_stages.data() + j * RHS::N;
+              for ( int i = 0; i < RHS::N; ++i )
+              {
+                stage_state[i] += a[s][j] * U_j[i];
+              }
+            }
+            this->call_rhs( current_time + alpha_sum[s] * h, stage_state, stage_rhs );
+          }
+
+          for ( int i = 0; i < RHS::N; ++i )
+          {
+            U_s[i] = stage_rhs[i] + gamma_sum[s] * h * m_dfdt[i];
+          }
+          for ( int j = 0; j < s; ++j )
+          {
+            const double* U_j = m_stages.data() + j * RHS::N;
+            for ( int i = 0; i < RHS::N; ++i )
+            {
+              U_s[i] += c[s][j] / h * U_j[i];
+            }
+          }
+
+          m_matrix.solve( U_s );
+        }
+
+        std::memcpy( next_state, current_state, sizeof( stage_state ) );
+        std::memset( error, 0, sizeof( error ) );
+        for ( int s = 0; s < S; ++s )
+        {
+          const double* U_s = m_stages.data() + s * RHS::N;
+          for ( int i = 0; i < RHS::N; ++i )
+          {
+            next_state[i] += m[s] * U_s[i];
+            error[i] += m_error[s] * U_s[i];
+          }
+        }
+
+        double err    = error_norm( error, current_state, next_state );
+        double factor = err > 0.0 ? 0.9 * std::pow( err, -1.0 / 3.0 ) : max_step_growth;
+        factor        = std::clamp( factor, max_step_decrease, max_step_growth );
+
+        if ( err <= 1.0 )
+        {
+          m_t0       = current_time;
+          m_h        = h;
+          m_f1_ready = false;
+          std::memcpy( m_y0, current_state, sizeof( m_y0 ) );
+          std::memcpy( m_y1, next_state, sizeof( m_y1 ) );
+
+          return { current_time + h, factor * h };
+        }
+
+        ++this->m_rejections;
+        h *= factor;
+      }
+    }
+
+    void dense_output( double t, double state[RHS::N] ) const override
+    {
+      if ( !m_f1_ready )
+      {
+        this->call_rhs( m_t0 + m_h, m_y1, m_f1 );
+        m_f1_ready = true;
+      }
+
+      HermiteInterpolation( ( t - m_t0 ) / m_h, m_h, m_y0, m_f0, m_y1, m_f1, state, RHS::N );
+    }
+  }; // class Rosenbrock_TimeStepper
+} // namespace ADAAI::Integration::Integrator::Stepper
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#include "BasicTimeStepper.hpp"
+#include "DenseOutput.hpp"
+
+namespace ADAAI::Integration::Integrator::Stepper
+{
+  /// \brief The weights of the composition of Störmer-Verlet steps of the given order
+  /// \details Order 2 is a single step, order 4 is the triple jump, orders 6 and 8 are
+  ///          H. Yoshida's solutions A (7 stages) and D (15 stages) (Phys. Lett. A 150, 1990)
+  template<int Order>
+  constexpr auto SymplecticCompositionWeights()
+  {
+    if constexpr ( Order == 2 )
+    {
+      return std::array<double, 1> { 1.0 };
+    }
+    else if constexpr ( Order == 4 )
+    {
+      // w1 = 1 / (2 - 2 ^ (1 / 3)), w0 = 1 - 2 * w1
+      constexpr double w1 = 1.3512071919596576340;
+      constexpr double w0 = 1.0 - 2.0 * w1;
+      return std::array<double, 3> { w1, w0, w1 };
+    }
+    else if constexpr ( Order == 6 )
+    {
+      constexpr double w1 = -1.17767998417887;
+      constexpr double w2 = 0.235573213359357;
+      constexpr double w3 = 0.784513610477560;
+      constexpr double w0 = 1.0 - 2.0 * ( w1 + w2 + w3 );
+      return std::array<double, 7> { w3, w2, w1, w0, w1, w2, w3 };
+    }
+    else
+    {
+      static_assert( Order == 8, "SymplecticCompositionWeights: The order must be 2, 4, 6 or 8" );
+
+      constexpr double w1 = 0.102799849391985;
+      constexpr double w2 = -1.96061023297549;
+      constexpr double w3 = 1.93813913762276;
+      constexpr double w4 = -0.158240635368243;
+      constexpr double w5 = -1.44485223686048;
+      constexpr double w6 = 0.253693336566229;
+      constexpr double w7 = 0.914844246229740;
+      constexpr double w0 = 1.0 - 2.0 * ( w1 + w2 + w3 + w4 + w5 + w6 + w7 );
+      return std::array<double, 15> { w7, w6, w5, w4, w3, w2, w1, w0, w1, w2, w3, w4, w5, w6, w7 };
+    }
+  }
+
+  /// \brief Fixed step symplectic integrator for y'' = F(y) (as the Everhart stepper, the state is y, dy/dt)
+  /// \details The composition of Störmer-Verlet (kick-drift-kick) steps. The energy error stays bounded
+  ///          over long times instead of drifting, so the steps can be much larger than of the adaptive steppers.
+  ///          F is the second half of the RHS and must not depend on dy/dt or on time.
+  /// \tparam Order 2 (Störmer-Verlet), 4, 6 or 8 (Yoshida compositions)
+  template<typename RHS, int Order = 4>
+  class Symplectic_TimeStepper : public TimeStepper<RHS>
+  {
+    static_assert( RHS::N % 2 == 0, "Symplectic_TimeStepper: The state must consist of y and dy/dt" );
+
+    constexpr static int  N2      = RHS::N / 2;
+    constexpr static auto weights = SymplecticCompositionWeights<Order>();
+
+    /// \brief The last accepted step (for the dense output and to reuse F at the end of the step)
+    struct History
+    {
+      bool   has_last_step = false;
+      double last_t0       = 0.0;
+      double last_h        = 0.0;
+      double last_y0[RHS::N];    // The state at the start of the last step
+      double last_f0[RHS::N];    // The RHS at the start of the last step
+      double last_state[RHS::N]; // The state at the end of the last step
+      double last_f1[RHS::N];    // The RHS at the end of the last step
+    };
+
+    mutable History m_history;
+
+  public:
+    explicit Symplectic_TimeStepper( const RHS* rhs )
+        : TimeStepper<RHS>( rhs )
+    {
+    }
+
+    void reset() const override
+    {
+      m_history.has_last_step = false;
+    }
+
+    void save( StepperSnapshot& snapshot ) const override
+    {
+      snapshot.put( m_history );
+    }
+
+    void load( StepperSnapshot& snapshot ) const override
+    {
+      snapshot.get( m_history );
+    }
+
+    /// \brief The stepper function
+    /// \param current_time The current time
+    /// \param current_state The current state of the system
+    /// \param next_state The next state of the system
+    /// \param suggested_d_time The (fixed) step
+    /// \return The next time (current_time + dt) and the same delta time
+
+    std::pair<double, double>
+    operator()( double current_state[RHS::N], double next_state[RHS::N], double current_time, double suggested_d_time = 1.0 ) const override
+    {
+      double h = suggested_d_time;
+      double f[RHS::N];
+
+      // F at the end of the last step is F at the start of this one if the trajectory is continued
+      bool continued = m_history.has_last_step &&
+                       current_time == m_history.last_t0 + m_history.last_h &&
+                       memcmp( current_state, m_history.last_state, sizeof( m_history.last_state ) ) == 0;
+
+      if ( continued )
+      {
+        memcpy( f, m_history.last_f1, sizeof( f ) );
+      }
+      else
+      {
+        this->call_rhs( current_time, current_state, f );
+      }
+
+      memcpy( m_history.last_y0, current_state, sizeof( m_history.last_y0 ) );
+      memcpy( m_history.last_f0, f, sizeof( m_history.last_f0 ) );
+      memcpy( next_state, current_state, sizeof( m_history.last_y0 ) );
+
+      double* y     = next_state;
+      double* dy_dt = next_state + N2;
+
+      // F at the end of a stage is F at the start of the next one: one RHS call per stage
+      double t = current_time;
+      for ( double w : weights )
+      {
+        double stage_h = w * h;
+
+        for ( int i = 0; i < N2; ++i )
+        {
+          dy_dt[i] += 0.5 * stage_h * f[i + N2];
+          y[i] += stage_h * dy_dt[i];
+        }
+
+        t += stage_h;
+        this->call_rhs( t, next_state, f );
+
+        for ( int i = 0; i < N2; ++i )
+        {
+          dy_dt[i] += 0.5 * stage_h * f[i + N2];
+          f[i] = dy_dt[i];
+        }
+      }
+
+      m_history.has_last_step = true;
+      m_history.last_t0       = current_time;
+      m_history.last_h        = h;
+      memcpy( m_history.last_state, next_state, sizeof( m_history.last_state ) );
+      memcpy( m_history.last_f1, f, sizeof( m_history.last_f1 ) );
+
+      return { current_time + h, h };
+    }
+
+    void dense_output( double t, double state[RHS::N] ) const override
+    {
+      const History& last = m_history;
+
+      HermiteInterpolation( ( t - last.last_t0 ) / last.last_h, last.last_h, last.last_y0, last.last_f0, last.last_state, last.last_f1, state, RHS::N );
+    }
+  }; // class Symplectic_TimeStepper
+} // namespace ADAAI::Integration::Integrator::Stepper
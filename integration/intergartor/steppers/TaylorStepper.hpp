@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <limits>
+#include <utility>
+
+#include "../../../diff/methods/TaylorTape.hpp"
+#include "BasicTimeStepper.hpp"
+
+namespace ADAAI::Integration::Integrator::Stepper
+{
+  /// \brief An RHS that can be evaluated on the Taylor tape of the state:
+  ///        'template<typename T> void evaluate( const T& t, const T* y, T* rhs ) const'
+  template<typename RHS, int Order>
+  concept TaylorRHS = requires( const RHS& rhs, const Diff::AAD::TaylorNode<Order>& t,
+                                const Diff::AAD::TaylorNode<Order>* y, Diff::AAD::TaylorNode<Order>* f ) {
+    rhs.template evaluate<Diff::AAD::TaylorNode<Order>>( t, y, f );
+  };
+
+  /// \brief The Taylor series method of high order
+  /// \details The coefficients of the solution y(t0 + h) = sum of y_k * h^k are computed by the automatic
+  ///          differentiation of the RHS: the coefficient k of f(t, y) is correct once y_0...y_k are known,
+  ///          so y_(k + 1) = f_k / (k + 1). The RHS is evaluated once per step on a Taylor tape, then the tape
+  ///          computes f_k from y_0...y_k only for k = 1...p - 1: O(p^2) per operation of the RHS and step.
+  ///          The step is chosen from the last two coefficients as in A. Jorba, M. Zou (Exp. Math. 14, 2005):
+  ///          h = exp(-0.7 / (p - 1)) * min((eps / |y_(p-1)|)^(1 / (p - 1)), (eps / |y_p|)^(1 / p)),
+  ///          so there is no rejected step. The dense output is the Taylor polynomial of the last step.
+  /// \tparam Order The order p of the method (the degree of the Taylor polynomial)
+  template<typename RHS, int Order = 20>
+    requires TaylorRHS<RHS, Order>
+  class Taylor_TimeStepper : public TimeStepper<RHS>
+  {
+    static_assert( Order >= 2, "Taylor_TimeStepper: The order must be at least 2" );
+
+    using Series = Diff::AAD::TaylorSeries<Order>;
+    using Node   = Diff::AAD::TaylorNode<Order>;
+
+    double m_tolerance;
+
+    mutable Diff::AAD::TaylorTape<Order> m_tape; // The operations of the RHS, recorded at the start of each step
+
+    // The last step data (for dense output)
+    mutable double m_t0 = 0.0;
+    mutable Series m_series[RHS::N];
+
+    /// \brief The infinity norm of the k-th coefficients
+    double coefficient_norm( int k ) const
+    {
+      double norm = 0.0;
+      for ( int i = 0; i < RHS::N; ++i )
+      {
+        norm = std::max( norm, std::abs( m_series[i][k] ) );
+      }
+      return norm;
+    }
+
+  public:
+    /// \param rhs The right-hand side of the system
+    /// \param tolerance The local error relative to max(1, |y|)
+    explicit Taylor_TimeStepper( const RHS* rhs, double tolerance = 1e-14 )
+        : TimeStepper<RHS>( rhs ), m_tolerance( tolerance )
+    {
+    }
+
+    /// \brief The stepper function
+    /// \param current_time The current time
+    /// \param current_state The current state of the system
+    /// \param next_state The next state of the system
+    /// \param suggested_d_time The upper bound of the step (e.g. the distance to the end of the integration)
+    /// \return The next time (current_time + dt) and the step chosen by the series at current_time
+
+    std::pair<double, double>
+    operator()( double current_state[RHS::N], double next_state[RHS::N], double current_time, double suggested_d_time = 1.0 ) const override
+    {
+      m_tape.clear();
+
+      Node time = m_tape.variable( current_time );
+      Node y[RHS::N];
+      Node f[RHS::N];
+
+      for ( int i = 0; i < RHS::N; ++i )
+      {
+        y[i] = m_tape.input( current_state[i] );
+      }
+
+      // The recording computes the coefficients 0, the tape the next ones
+      this->m_rhs->evaluate( time, y, f );
+      ++this->m_rhs_calls;
+
+      for ( int k = 0; k < Order; ++k )
+      {
+        if ( k > 0 )
+        {
+          m_tape.compute( k );
+        }
+        for ( int i = 0; i < RHS::N; ++i )
+        {
+          m_tape.series( y[i] )[k + 1] = f[i].series()[k] / ( k + 1 );
+        }
+      }
+
+      for ( int i = 0; i < RHS::N; ++i )
+      {
+        m_series[i] = y[i].series();
+      }
+
+      double epsilon = m_tolerance * std::max( 1.0, coefficient_norm( 0 ) );
+      double safety  = std::exp( -0.7 / ( Order - 1 ) );
+
+      double step = std::numeric_limits<double>::infinity();
+      for ( int k : { Order - 1, Order } )
+      {
+        double norm = coefficient_norm( k );
+        if ( norm > 0.0 )
+        {
+          step = std::min( step, std::pow( epsilon / norm, 1.0 / k ) );
+        }
+      }
+      step *= safety;
+
+      double h = std::isfinite( step ) ? std::min( step, suggested_d_time ) : suggested_d_time;
+
+      for ( int i = 0; i < RHS::N; ++i )
+      {
+        next_state[i] = m_series[i].evaluate( h );
+      }
+      m_t0 = current_time;
+
+      return { current_time + h, std::isfinite( step ) ? step : suggested_d_time };
+    }
+
+    void dense_output( double t, double state[RHS::N] ) const override
+    {
+      for ( int i = 0; i < RHS::N; ++i )
+      {
+        state[i] = m_series[i].evaluate( t - m_t0 );
+      }
+    }
+  }; // class Taylor_TimeStepper
+} // namespace ADAAI::Integration::Integrator::Stepper
@@ -2,6 +2,7 @@
 
 #include "../environment/ComputeFunctions.hpp"
 #include "../intergartor/Observer.hpp"
+#include "../intergartor/TrajectoryWriter.hpp"
 
 /// Integrator implementation for the satellite launcher
 
@@ -17,21 +18,41 @@ namespace ADAAI::Integration::Satellite
     // float v_y;
     // float v_z;
 
+    double m_j2;
+
   public:
     constexpr static int N = 6; // x, y, z, v_x, v_y, v_z
 
-    SatelliteRHS() = default;
+    /// \param j2 The J2 coefficient of the gravity of the Earth (0: the two-body Kepler problem)
+    explicit SatelliteRHS( double j2 = Environment::J2 )
+        : m_j2( j2 )
+    {
+    }
 
-    void operator()( [[maybe_unused]] double current_time, const double* current_state, double* rhs ) const override
+    void operator()( double current_time, const double* current_state, double* rhs ) const override
+    {
+      evaluate( current_time, current_state, rhs );
+    }
+
+    /// \brief The right-hand side for double or an AD type (e.g. the Taylor series of the state)
+    template<typename T>
+    void evaluate( [[maybe_unused]] const T& current_time, const T* current_state, T* rhs ) const
     {
       rhs[0] = current_state[3];
       rhs[1] = current_state[4];
       rhs[2] = current_state[5];
 
-      Environment::ComputeUGradient( current_state, rhs + 3 );
+      Environment::ComputeUGradient( current_state, rhs + 3, m_j2 );
     }
   };
 
+  /// \brief The total energy per unit mass (conserved by the exact solution)
+  inline double SatelliteEnergy( const double current_state[SatelliteRHS::N] )
+  {
+    double v2 = current_state[3] * current_state[3] + current_state[4] * current_state[4] + current_state[5] * current_state[5];
+    return v2 / 2.0 + Environment::ComputeU( current_state );
+  }
+
   struct SatelliteObserver : Integrator::Observer<SatelliteRHS>
   {
     bool operator()( double current_time, [[maybe_unused]] const double current_state[SatelliteRHS::N] ) const override
@@ -40,57 +61,17 @@ namespace ADAAI::Integration::Satellite
     }
   };
 
-  struct SatelliteDumperObserver : Integrator::Observer<SatelliteRHS>
+  /// \brief Stops after a year or when the satellite falls to the Earth
+  struct SatelliteFlightObserver : Integrator::Observer<SatelliteRHS>
   {
-    std::ostream& m_os;
-
-    explicit SatelliteDumperObserver( std::ostream& os )
-        : m_os( os )
-    {
-    }
-
     bool operator()( double current_time, const double current_state[SatelliteRHS::N] ) const override
     {
-      static int ind = 0;
-
-      double rhs[SatelliteRHS::N] {};
-      SatelliteRHS {}( current_time, current_state, rhs );
-
-      double
-          x = current_state[0],
-          y = current_state[1],
-          z = current_state[2];
-      double
-          v_x = current_state[3],
-          v_y = current_state[4],
-          v_z = current_state[5];
-      double
-          a_x = rhs[3],
-          a_y = rhs[4],
-          a_z = rhs[5];
-
-      if ( ( ind++ ) % 10 == 0 )
-      {
-        m_os << "  {\n"
-             << "    \"current_time\":" << current_time << ",\n"
-             << "    \"current_state\": {\n"
-             << "      \"x\": " << x << ",\n"
-             << "      \"y\": " << y << ",\n"
-             << "      \"z\": " << z << ",\n"
-             << "      \"v_x\": " << v_x << ",\n"
-             << "      \"v_y\": " << v_y << ",\n"
-             << "      \"v_z\": " << v_z << ",\n"
-             << "      \"a_x\": " << a_x << ",\n"
-             << "      \"a_y\": " << a_y << ",\n"
-             << "      \"a_z\": " << a_z << "\n"
-             << "    }\n"
-             << "  },\n";
-      }
-
-      double
-          r2 = x * x + y * y + z * z;
+      double r2 = current_state[0] * current_state[0] + current_state[1] * current_state[1] + current_state[2] * current_state[2];
 
       return current_time <= 3.1e7 && r2 > 8000; // 1 year
     }
   };
+
+  /// \brief Writes every 10th state with the RHS to a trajectory file
+  using SatelliteDumperObserver = Integrator::TrajectoryObserver<SatelliteRHS, SatelliteFlightObserver>;
 } // namespace ADAAI::Integration::Satellite
@@ -1,7 +1,9 @@
-#include <fstream>
 #include <iostream>
+#include <string>
 #include <vector>
 
+#include "../intergartor/AsyncObserver.hpp"
+#include "../intergartor/Checkpoint.hpp"
 #include "../intergartor/Interator.hpp"
 #include "../intergartor/steppers/EverhartStepper.hpp"
 #include "Satellite.hpp"
@@ -11,46 +13,76 @@ namespace ADAAI::Integration::Satellite
   constexpr static double Altitude = 7500.0f;                    // Altitude of the satellite (km). From center of the Earth
   constexpr static double V02      = Environment::Mu / Altitude; // Initial velocity (km/s)
 
-  void launchSatellite()
+  /// \brief Integrates the orbit for about a year, a checkpoint is written every 100000 steps
+  /// \param resume If the integration continues from the last checkpoint (the trajectory after it is written
+  ///               to Satellite_trajectory_resumed.bin)
+  void launchSatellite( bool resume = false )
   {
-    std::ofstream file;
-    file.open( "./../data/Satellite_trajectory.json", std::ios::out | std::ios::trunc );
-    file << "[\n";
+    const std::string checkpoint_path = "./../data/Satellite_checkpoint.bin";
 
     double state[6] = { 0.0f, 0.0f, Altitude, std::sqrt( V02 ), 0.0f, 0.0f };
     double end_state[6];
 
-    auto rhs      = SatelliteRHS();
-    auto observer = SatelliteDumperObserver( file );
+    auto rhs    = SatelliteRHS();
+    auto writer = Integrator::TrajectoryWriter<SatelliteRHS>( resume ? "./../data/Satellite_trajectory_resumed.bin" : "./../data/Satellite_trajectory.bin", true );
+
+    // Every 10th state is written with its RHS on the consumer thread
+    long index  = 0;
+    auto dumper = [&]( double current_time, const double* current_state )
+    {
+      if ( ( index++ ) % 10 == 0 )
+      {
+        double current_rhs[SatelliteRHS::N];
+        rhs( current_time, current_state, current_rhs );
+        writer.append( current_time, current_state, current_rhs );
+      }
+    };
+
+    using DumperObserver = Integrator::AsyncObserver<SatelliteRHS, SatelliteFlightObserver>;
+
+    auto observer = DumperObserver( dumper );
     auto stepper  = Integrator::Stepper::Everhart_TimeStepper( &rhs );
 
-    auto integrator = Integrator::ODE_Integrator<SatelliteRHS, Integrator::Stepper::Everhart_TimeStepper<SatelliteRHS>>( &stepper, &observer );
+    auto integrator = Integrator::ODE_Integrator<SatelliteRHS, Integrator::Stepper::Everhart_TimeStepper<SatelliteRHS>, DumperObserver>( &stepper, &observer );
+
+    auto checkpoints = Integrator::CheckpointWriter( checkpoint_path );
+    integrator.setCheckpoints( &checkpoints, 100000 );
 
-    double t = 0.0;
+    double t         = 0.0;
+    bool   completed = false;
     try
     {
-      t = integrator( state, end_state, 0.0, 4e7, 3.0 );
+      t = resume ? integrator.resume( Integrator::ReadCheckpoint( checkpoint_path ), end_state, 4e7 )
+                 : integrator( state, end_state, 0.0, 4e7, 3.0 );
+      completed = true;
     }
     catch ( std::exception& e )
     {
       std::cerr << e.what() << std::endl;
     }
 
-    file << "  {\n"
-         << "    \"current_time\": " << t << ",\n"
-         << "    \"current_state\": {\n"
-         << "      \"x\": " << end_state[0] << ",\n"
-         << "      \"y\": " << end_state[1] << ",\n"
-         << "      \"z\": " << end_state[2] << ",\n"
-         << "      \"v_x\": " << end_state[3] << ",\n"
-         << "      \"v_y\": " << end_state[4] << ",\n"
-         << "      \"v_z\": " << end_state[5] << ",\n"
-         << "      \"a_x\": " << 0 << ",\n"
-         << "      \"a_y\": " << 0 << ",\n"
-         << "      \"a_z\": " << 0 << "\n"
-         << "    }\n"
-         << "  }\n";
-    file << "]\n";
-    file.close();
+    // The consumer thread appends to the writer too, so it is joined before the last row (whatever the result)
+    auto report = []( auto finish )
+    {
+      try
+      {
+        finish();
+      }
+      catch ( std::exception& e )
+      {
+        std::cerr << e.what() << std::endl;
+      }
+    };
+    report( [&]
+            { observer.finish(); } );
+    report( [&]
+            { checkpoints.finish(); } );
+
+    if ( completed )
+    {
+      double end_rhs[6];
+      rhs( t, end_state, end_rhs );
+      writer.append( t, end_state, end_rhs );
+    }
   }
 } // namespace ADAAI::Integration::Satellite
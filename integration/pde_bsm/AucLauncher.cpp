@@ -1,4 +1,5 @@
 #include <iostream>
+#include <vector>
 
 #include "../intergartor/Interator.hpp"
 #include "AucRHS.hpp"
@@ -12,7 +13,12 @@ namespace ADAAI::Integration::PDE_BSM
   {
     ANALYTICAL,
     EXPLICIT,
-    IMPLICIT
+    IMPLICIT,
+    GSL,
+    ROSENBROCK,
+    RADAU,
+    AUTO_SWITCH,
+    EXPONENTIAL
   };
 
   double launchAuc( SolutionApproach approach = SolutionApproach::ANALYTICAL )
@@ -28,8 +34,47 @@ namespace ADAAI::Integration::PDE_BSM
         return Numerical::solveNumerical( S_tau_max, tau_max, Numerical::SolutionApproach::EXPLICIT );
       case SolutionApproach::IMPLICIT:
         return Numerical::solveNumerical( S_tau_max, tau_max, Numerical::SolutionApproach::IMPLICIT );
+      case SolutionApproach::GSL:
+        return Numerical::solveNumerical( S_tau_max, tau_max, Numerical::SolutionApproach::GSL );
+      case SolutionApproach::ROSENBROCK:
+        return Numerical::solveNumerical( S_tau_max, tau_max, Numerical::SolutionApproach::ROSENBROCK );
+      case SolutionApproach::RADAU:
+        return Numerical::solveNumerical( S_tau_max, tau_max, Numerical::SolutionApproach::RADAU );
+      case SolutionApproach::AUTO_SWITCH:
+        return Numerical::solveNumerical( S_tau_max, tau_max, Numerical::SolutionApproach::AUTO_SWITCH );
+      case SolutionApproach::EXPONENTIAL:
+        return Numerical::solveNumerical( S_tau_max, tau_max, Numerical::SolutionApproach::EXPONENTIAL );
     }
 
     throw std::invalid_argument( "Unknown solution approach" );
   }
+
+  /// @brief The premiums by Radau IIA on the grids of 'sizes' stock prices (the grids are chosen at runtime)
+  /// @details The solves share the scratch memory, so only the first steps of the largest grid allocate it
+  std::vector<double> launchAucOnGrids( const std::vector<int>& sizes )
+  {
+    int    S_tau_max = 0.9 * AucRHS::K;
+    double tau_max   = 1.0;
+
+    Integrator::Arena   arena;
+    std::vector<double> premiums;
+    for ( int size : sizes )
+    {
+      premiums.push_back( Numerical::solveOnGrid( S_tau_max, tau_max, size, arena ) );
+    }
+
+    return premiums;
+  }
+
+  /// @brief The premium and its sensitivities to the sigma (0...3) and r (4...7) buckets
+  std::array<double, AucRHS::NP> launchAucSensitivities()
+  {
+    int    S_tau_max = 0.9 * AucRHS::K;
+    double tau_max   = 1.0;
+
+    std::array<double, AucRHS::NP> sensitivities {};
+    Numerical::solveSensitivities( S_tau_max, tau_max, sensitivities.data() );
+
+    return sensitivities;
+  }
 } // namespace ADAAI::Integration::PDE_BSM
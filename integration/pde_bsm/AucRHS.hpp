@@ -1,13 +1,26 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
 #include "../intergartor/Observer.hpp"
+#include "../intergartor/State.hpp"
+#include "../intergartor/linalg/BandMatrix.hpp"
 #include "AuxiliaryFunctions.hpp"
 
 namespace ADAAI::Integration::PDE_BSM
 {
-  struct AucRHS : Integrator::RHS
+  /// \brief The Black-Scholes PDE on the grid of 'Size' stock prices (Integrator::Dynamic: the grid is set at runtime)
+  template<int Size>
+  struct BasicAucRHS : Integrator::RHS
   {
-    constexpr static int N = 502; // Number of equations
+    constexpr static int N  = Size; // Number of equations
+    constexpr static int ML = 1;    // The Jacobian is tridiagonal
+    constexpr static int MU = 1;
+
+    constexpr static std::array<double, 3> breakpoints = { 0.25, 0.5, 0.75 }; // sigma and r are constant between them
+    constexpr static int                   NP          = 8;                   // The sigma and r buckets (for the adjoint)
 
     constexpr static double tau_max = 1.0;
     constexpr static int    K       = 100; // Strike price
@@ -15,20 +28,87 @@ namespace ADAAI::Integration::PDE_BSM
 
     // double S[ N ]; // Stock price
 
-    AucRHS()
+    /// \param size The number of the stock prices (by default the compile-time one)
+    explicit BasicAucRHS( int size = Size )
+        : m_size( size )
     {
+      if ( size < 4 )
+      {
+        throw std::invalid_argument( "AucRHS: The grid must have at least 4 stock prices" );
+      }
       // for ( int i = 0; i < N; i++ )
       // {
       //   S[ i ] = i * S_max / N;
       // }
     }
 
+    int size() const
+    {
+      return m_size;
+    }
+
+    /// \brief The bumps of the term structure: sigma (0...3) and r (4...7) between the breakpoints
+    std::array<double, NP> parameters {};
+
+    /// \brief The bucket of sigma at tau (sigma jumps right at the breakpoints)
+    static int sigma_bucket( double tau )
+    {
+      return static_cast<int>( std::upper_bound( breakpoints.begin(), breakpoints.end(), tau ) - breakpoints.begin() );
+    }
+
+    /// \brief The bucket of r at tau (r jumps right after the breakpoints)
+    static int r_bucket( double tau )
+    {
+      return static_cast<int>( std::lower_bound( breakpoints.begin(), breakpoints.end(), tau ) - breakpoints.begin() );
+    }
+
+    /// \brief d(integral of r from 0 to tau) / d(r of the bucket)
+    static double r_bucket_length( int bucket, double tau )
+    {
+      double lower = bucket == 0 ? 0.0 : breakpoints[bucket - 1];
+      double upper = bucket == NP / 2 - 1 ? tau : std::min( tau, breakpoints[bucket] );
+      return std::max( 0.0, upper - lower );
+    }
+
+    double sigma( double tau ) const
+    {
+      return AUX_FUNC::sigma_function( tau ) + parameters[sigma_bucket( tau )];
+    }
+
+    double r( double tau ) const
+    {
+      return AUX_FUNC::risk_free_interest_rate_function( tau ) + parameters[NP / 2 + r_bucket( tau )];
+    }
+
+    double r_integral( double tau ) const
+    {
+      double integral = AUX_FUNC::get_r_integral( tau );
+      for ( int bucket = 0; bucket < NP / 2; ++bucket )
+      {
+        integral += parameters[NP / 2 + bucket] * r_bucket_length( bucket, tau );
+      }
+      return integral;
+    }
+
+    /// \brief The price at S_max (the upper boundary condition)
+    double upper_boundary( double tau ) const
+    {
+      return S_max - K * std::exp( -r_integral( tau ) );
+    }
+
     void operator()( double current_time, const double* current_state, double* rhs ) const override
     {
-      double sigma_tau  = AUX_FUNC::sigma_function( current_time );
+      const int n = m_size;
+
+      double r_tau      = r( current_time );
+      double sigma_tau  = sigma( current_time );
       double sigma_tau2 = sigma_tau * sigma_tau;
 
-      for ( int i = 1; i < N - 1; ++i )
+      // The boundary values are kept by the boundary conditions
+      rhs[0]     = 0.0;
+      rhs[n - 1] = 0.0;
+
+      for ( int i = 1; i < n - 1; ++i )
       {
         double prev_c = current_state[i - 1];
         double curr_c = current_state[i];
@@ -38,51 +118,147 @@ namespace ADAAI::Integration::PDE_BSM
         {
           prev_c = 0;
         }
-        if ( i == N - 2 )
+        if ( i == n - 2 )
         {
-          next_c = S_max - K * std::exp( -AUX_FUNC::get_r_integral( current_time ) );
+          next_c = upper_boundary( current_time );
         }
 
         rhs[i] =
-            AUX_FUNC::risk_free_interest_rate_function( current_time ) * i * ( next_c - prev_c ) / 2.0 +
+            r_tau * i * ( next_c - prev_c ) / 2.0 +
             sigma_tau2 * i * i * ( next_c - 2.0 * curr_c + prev_c ) / 2.0 -
-            AUX_FUNC::risk_free_interest_rate_function( current_time ) * curr_c;
+            r_tau * curr_c;
       }
     }
+
+    /// \brief The Jacobian d(rhs)/d(state) for the stiff steppers (the boundary rows are zero)
+    void jacobian( double current_time, [[maybe_unused]] const double* current_state, Integrator::Linalg::BandMatrix& J ) const
+    {
+      const int n = m_size;
+
+      double r_tau      = r( current_time );
+      double sigma_tau  = sigma( current_time );
+      double sigma_tau2 = sigma_tau * sigma_tau;
+
+      for ( int i = 1; i < n - 1; ++i )
+      {
+        // The neighbours of the boundary rows are replaced with the boundary conditions
+        if ( i != 1 )
+        {
+          J( i, i - 1 ) = -r_tau * i / 2.0 + sigma_tau2 * i * i / 2.0;
+        }
+        if ( i != n - 2 )
+        {
+          J( i, i + 1 ) = r_tau * i / 2.0 + sigma_tau2 * i * i / 2.0;
+        }
+        J( i, i ) = -sigma_tau2 * i * i - r_tau;
+      }
+    }
+
+    /// \brief The vector-Jacobian products for the adjoint: w_y = lambda^T d(rhs)/d(state), w_p = lambda^T d(rhs)/d(parameters)
+    void vjp( double current_time, const double* current_state, const double* lambda, double* w_y, double* w_p ) const
+    {
+      const int n = m_size;
+
+      double r_tau      = r( current_time );
+      double sigma_tau  = sigma( current_time );
+      double sigma_tau2 = sigma_tau * sigma_tau;
+      double boundary   = upper_boundary( current_time );
+
+      std::fill( w_y, w_y + n, 0.0 );
+      std::fill( w_p, w_p + NP, 0.0 );
+
+      double d_sigma = 0.0;
+      double d_r     = 0.0;
+      for ( int i = 1; i < n - 1; ++i )
+      {
+        double prev_c = i == 1 ? 0.0 : current_state[i - 1];
+        double curr_c = current_state[i];
+        double next_c = i == n - 2 ? boundary : current_state[i + 1];
+
+        if ( i != 1 )
+        {
+          w_y[i - 1] += lambda[i] * ( -r_tau * i / 2.0 + sigma_tau2 * i * i / 2.0 );
+        }
+        if ( i != n - 2 )
+        {
+          w_y[i + 1] += lambda[i] * ( r_tau * i / 2.0 + sigma_tau2 * i * i / 2.0 );
+        }
+        w_y[i] += lambda[i] * ( -sigma_tau2 * i * i - r_tau );
+
+        d_sigma += lambda[i] * sigma_tau * i * i * ( next_c - 2.0 * curr_c + prev_c );
+        d_r += lambda[i] * ( i * ( next_c - prev_c ) / 2.0 - curr_c );
+      }
+
+      w_p[sigma_bucket( current_time )] += d_sigma;
+      w_p[NP / 2 + r_bucket( current_time )] += d_r;
+
+      // The upper boundary depends on the integral of r
+      const int i          = n - 2;
+      double        d_next = lambda[i] * ( r_tau * i / 2.0 + sigma_tau2 * i * i / 2.0 ) * K * std::exp( -r_integral( current_time ) );
+      for ( int bucket = 0; bucket < NP / 2; ++bucket )
+      {
+        w_p[NP / 2 + bucket] += d_next * r_bucket_length( bucket, current_time );
+      }
+    }
+
+  private:
+    int m_size;
   };
 
+  using AucRHS        = BasicAucRHS<502>;
+  using DynamicAucRHS = BasicAucRHS<Integrator::Dynamic>;
+
+  /// \details 'size' is the number of the stock prices of the grid
   struct AucFunc
   {
-    static double get_c( double* state, double S_tau )
+    static double get_c( double* state, double S_tau, int size = AucRHS::N )
     {
       int i = 0;
-      while ( i * AucRHS::S_max / AucRHS::N <= S_tau )
+      while ( i * AucRHS::S_max / size <= S_tau )
       {
         i++;
       }
 
       i--;
-      S_tau -= i * AucRHS::S_max / AucRHS::N;
+      S_tau -= i * AucRHS::S_max / size;
 
       return state[i] * ( 1.0 - S_tau ) + state[i + 1] * S_tau;
     }
 
-    static void initStartCondition( double* state )
+    /// \brief The gradient of get_c with respect to the state
+    static void get_c_gradient( double* gradient, double S_tau, int size = AucRHS::N )
+    {
+      int i = 0;
+      while ( i * AucRHS::S_max / size <= S_tau )
+      {
+        i++;
+      }
+
+      i--;
+      S_tau -= i * AucRHS::S_max / size;
+
+      std::fill( gradient, gradient + size, 0.0 );
+      gradient[i]     = 1.0 - S_tau;
+      gradient[i + 1] = S_tau;
+    }
+
+    static void initStartCondition( double* state, int size = AucRHS::N )
     {
-      for ( int i = 0; i < AucRHS::N; i++ )
+      for ( int i = 0; i < size; i++ )
       {
-        state[i] = std::max( i * AucRHS::S_max / AucRHS::N - AucRHS::K, 0.0 );
+        state[i] = std::max( i * AucRHS::S_max / size - AucRHS::K, 0.0 );
       }
     }
   };
 
-  struct AucObserver : Integrator::Observer<AucRHS>
+  template<typename RHS_I = AucRHS>
+  struct AucObserver : Integrator::Observer<RHS_I>
   {
     explicit AucObserver()
     {
     }
 
-    bool operator()( double current_time, [[maybe_unused]] const double current_state[AucRHS::N] ) const override
+    bool operator()( double current_time, [[maybe_unused]] const double current_state[] ) const override
     {
       return current_time < 1.0;
     }
@@ -108,6 +108,9 @@ namespace ADAAI::Integration::PDE_BSM::Implicit
       static double matrix[N][N];
       static double F_i[N];
 
+      // The scheme is linear: the tridiagonal solve is the single (exact) Newton iteration of the step
+      ++this->m_iterations;
+
       init_matrix( matrix, current_time, suggested_d_time );
       init_F_i( F_i, matrix, current_state, current_time, suggested_d_time );
 
@@ -1,6 +1,13 @@
 #include <math.h>
 #include <utility>
+#include <vector>
 
+#include "../../intergartor/Adjoint.hpp"
+#include "../../intergartor/steppers/AutoSwitchStepper.hpp"
+#include "../../intergartor/steppers/ExponentialStepper.hpp"
+#include "../../intergartor/steppers/GSLTimeStepper.hpp"
+#include "../../intergartor/steppers/RadauIIAStepper.hpp"
+#include "../../intergartor/steppers/RosenbrockStepper.hpp"
 #include "../AucRHS.hpp"
 #include "ImplicitSolution.cpp"
 
@@ -9,7 +16,12 @@ namespace ADAAI::Integration::PDE_BSM::Numerical
   enum class SolutionApproach
   {
     EXPLICIT,
-    IMPLICIT
+    IMPLICIT,
+    GSL,
+    ROSENBROCK,
+    RADAU,
+    AUTO_SWITCH,
+    EXPONENTIAL
   };
 
   /// @brief r_tau
@@ -36,6 +48,42 @@ namespace ADAAI::Integration::PDE_BSM::Numerical
 
         integrator( state, end_state, 0.0, tau_max, delta_tau );
       }
+      else if ( approach == SolutionApproach::GSL )
+      {
+        auto stepper    = Integrator::Stepper::GSLTimeStepper( &rhs, Integrator::Stepper::GSLMethod::MSBDF );
+        auto integrator = Integrator::ODE_Integrator<AucRHS, Integrator::Stepper::GSLTimeStepper<AucRHS>>( &stepper, &observer );
+
+        integrator( state, end_state, 0.0, tau_max, delta_tau );
+      }
+      else if ( approach == SolutionApproach::ROSENBROCK )
+      {
+        auto stepper    = Integrator::Stepper::Rosenbrock_TimeStepper( &rhs );
+        auto integrator = Integrator::ODE_Integrator<AucRHS, Integrator::Stepper::Rosenbrock_TimeStepper<AucRHS>>( &stepper, &observer );
+
+        integrator( state, end_state, 0.0, tau_max, delta_tau );
+      }
+      else if ( approach == SolutionApproach::RADAU )
+      {
+        auto stepper    = Integrator::Stepper::RadauIIA_TimeStepper( &rhs );
+        auto integrator = Integrator::ODE_Integrator<AucRHS, Integrator::Stepper::RadauIIA_TimeStepper<AucRHS>>( &stepper, &observer );
+
+        integrator( state, end_state, 0.0, tau_max, delta_tau );
+      }
+      else if ( approach == SolutionApproach::AUTO_SWITCH )
+      {
+        auto stepper    = Integrator::Stepper::AutoSwitch_TimeStepper( &rhs );
+        auto integrator = Integrator::ODE_Integrator<AucRHS, Integrator::Stepper::AutoSwitch_TimeStepper<AucRHS>>( &stepper, &observer );
+
+        integrator( state, end_state, 0.0, tau_max, delta_tau );
+      }
+      else if ( approach == SolutionApproach::EXPONENTIAL )
+      {
+        // The steps stop at the breakpoints of sigma and r only
+        auto stepper    = Integrator::Stepper::Exponential_TimeStepper( &rhs );
+        auto integrator = Integrator::ODE_Integrator<AucRHS, Integrator::Stepper::Exponential_TimeStepper<AucRHS>>( &stepper, &observer );
+
+        integrator( state, end_state, 0.0, tau_max, tau_max );
+      }
       else
       {
         auto stepper    = Implicit::ImplicitStepper( &rhs );
@@ -51,4 +99,60 @@ namespace ADAAI::Integration::PDE_BSM::Numerical
 
     return AucFunc::get_c( end_state, S_tau_max );
   }
+
+  /// @brief The premium by Radau IIA on a grid of 'size' stock prices chosen at runtime
+  /// @param arena The scratch memory of the steps (shared by the solves, so it is allocated by the first one only)
+  double solveOnGrid( double S_tau_max, double tau_max, int size, Integrator::Arena& arena )
+  {
+    double delta_tau = tau_max / 1000;
+
+    std::vector<double> state( size );
+    std::vector<double> end_state( size );
+
+    AucFunc::initStartCondition( state.data(), size );
+
+    auto rhs      = DynamicAucRHS( size );
+    auto observer = AucObserver<DynamicAucRHS>();
+
+    try
+    {
+      auto stepper = Integrator::Stepper::RadauIIA_TimeStepper( &rhs );
+      stepper.setArena( &arena );
+      auto integrator = Integrator::ODE_Integrator<DynamicAucRHS, Integrator::Stepper::RadauIIA_TimeStepper<DynamicAucRHS>>( &stepper, &observer );
+
+      integrator( state.data(), end_state.data(), 0.0, tau_max, delta_tau );
+    }
+    catch ( std::exception& e )
+    {
+      std::cerr << e.what() << std::endl;
+    }
+
+    return AucFunc::get_c( end_state.data(), S_tau_max, size );
+  }
+
+  /// @brief The premium and its sensitivities to the sigma and r buckets by the adjoint of RK4
+  /// @param sensitivities d(premium)/d(sigma) of the 4 buckets followed by d(premium)/d(r)
+  /// @return The premium
+  double solveSensitivities( double S_tau_max, double tau_max, double sensitivities[AucRHS::NP] )
+  {
+    // RK4 is stable for h * 2 * sigma_max^2 * N^2 < 2.78
+    int steps = 20000;
+
+    double state[AucRHS::N];
+    double end_state[AucRHS::N];
+    double d_premium[AucRHS::N];
+    double d_state[AucRHS::N];
+
+    AucFunc::initStartCondition( state );
+
+    auto rhs        = AucRHS();
+    auto integrator = Integrator::AdjointRK4_Integrator<AucRHS>( &rhs );
+
+    integrator.forward( state, end_state, 0.0, tau_max, steps );
+
+    AucFunc::get_c_gradient( d_premium, S_tau_max );
+    integrator.backward( d_premium, d_state, sensitivities );
+
+    return AucFunc::get_c( end_state, S_tau_max );
+  }
 } // namespace ADAAI::Integration::PDE_BSM::Numerical
@@ -8,6 +8,11 @@
 #  include "diff/TestDiff.hpp"
 #endif
 
+//#define INTEGRATION_TEST
+#ifdef INTEGRATION_TEST
+#  include "integration/TestIntegration.hpp"
+#endif
+
 //#define INTEGRATION_CANNON_PROBLEM
 #ifdef INTEGRATION_CANNON_PROBLEM
 #  include "integration/cannon_problem/Cannon.cpp"
@@ -35,6 +40,9 @@ int main()
 #endif
 
   // Integration part
+#ifdef INTEGRATION_TEST
+  TestIntegration();
+#endif
 #ifdef INTEGRATION_CANNON_PROBLEM
   double ang = ADAAI::Integration::Cannon::findBestAngle();
   std::cout << "Best angle: " << ang << std::endl;
@@ -48,10 +56,40 @@ int main()
   double analytical = ADAAI::Integration::PDE_BSM::launchAuc( ADAAI::Integration::PDE_BSM::SolutionApproach::ANALYTICAL );
   double explicit_  = ADAAI::Integration::PDE_BSM::launchAuc( ADAAI::Integration::PDE_BSM::SolutionApproach::EXPLICIT );
   double implicit_  = ADAAI::Integration::PDE_BSM::launchAuc( ADAAI::Integration::PDE_BSM::SolutionApproach::IMPLICIT );
+  double gsl_       = ADAAI::Integration::PDE_BSM::launchAuc( ADAAI::Integration::PDE_BSM::SolutionApproach::GSL );
+  double rosenbrock = ADAAI::Integration::PDE_BSM::launchAuc( ADAAI::Integration::PDE_BSM::SolutionApproach::ROSENBROCK );
+  double radau      = ADAAI::Integration::PDE_BSM::launchAuc( ADAAI::Integration::PDE_BSM::SolutionApproach::RADAU );
+  double auto_      = ADAAI::Integration::PDE_BSM::launchAuc( ADAAI::Integration::PDE_BSM::SolutionApproach::AUTO_SWITCH );
+  double exp_       = ADAAI::Integration::PDE_BSM::launchAuc( ADAAI::Integration::PDE_BSM::SolutionApproach::EXPONENTIAL );
 
   std::cout << "Actual Premium = " << analytical << '\n';
   std::cout << "Explicit Premium = " << explicit_ << '\n';
   std::cout << "Implicit Premium = " << implicit_ << '\n';
+  std::cout << "GSL Premium = " << gsl_ << '\n';
+  std::cout << "Rosenbrock Premium = " << rosenbrock << '\n';
+  std::cout << "Radau IIA Premium = " << radau << '\n';
+  std::cout << "Auto Switch Premium = " << auto_ << '\n';
+  std::cout << "Exponential Premium = " << exp_ << '\n';
+
+  std::vector<int> sizes    = { 252, 502, 1002 };
+  auto             premiums = ADAAI::Integration::PDE_BSM::launchAucOnGrids( sizes );
+  for ( std::size_t k = 0; k < sizes.size(); ++k )
+  {
+    std::cout << "Radau IIA Premium (" << sizes[k] << " prices) = " << premiums[k] << '\n';
+  }
+
+  auto sensitivities = ADAAI::Integration::PDE_BSM::launchAucSensitivities();
+  std::cout << "Premium sensitivities to the sigma buckets:";
+  for ( int k = 0; k < 4; ++k )
+  {
+    std::cout << ' ' << sensitivities[k];
+  }
+  std::cout << "\nPremium sensitivities to the r buckets:";
+  for ( int k = 4; k < 8; ++k )
+  {
+    std::cout << ' ' << sensitivities[k];
+  }
+  std::cout << '\n';
 #endif
 
   return 0;